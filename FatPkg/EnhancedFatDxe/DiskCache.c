@@ -209,11 +209,62 @@ FatGetCachePage (
   return Status;
 }
 
+/**
+
+  Write the dirty data cache pages in the specified range back to the disk.
+
+  This is needed before the range is read from the disk with a non-blocking
+  request: the data is only copied into the user buffer when the request
+  completes, so it cannot be patched up with the dirty cache data afterwards.
+
+  @param  Volume                - FAT file system volume.
+  @param  StartPageNo           - First PageNo to be checked in the cache.
+  @param  EndPageNo             - Last PageNo to be checked in the cache.
+
+  @retval EFI_SUCCESS           - The dirty pages were written back.
+  @return Others                - An error occurred when writing the disk.
+
+**/
+STATIC
+EFI_STATUS
+FatWriteBackDataCacheRange (
+  IN  FAT_VOLUME         *Volume,
+  IN  UINTN              StartPageNo,
+  IN  UINTN              EndPageNo
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       PageNo;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *CacheTag;
+
+  DiskCache = &Volume->DiskCache[CacheData];
+  if (!DiskCache->Dirty) {
+    return EFI_SUCCESS;
+  }
+
+  for (PageNo = StartPageNo; PageNo < EndPageNo; PageNo++) {
+    CacheTag = &DiskCache->CacheTag[PageNo & DiskCache->GroupMask];
+    if (CacheTag->RealSize > 0 && CacheTag->PageNo == PageNo && CacheTag->Dirty) {
+      Status = FatExchangeCachePage (Volume, CacheData, WriteDisk, CacheTag, NULL);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
 
   Read Length bytes from the position of Offset into Buffer, or
   write Length bytes from Buffer into the position of Offset.
 
+  A non-blocking read of a data cache page which is not cached is not
+  loaded into the cache; the requested bytes are read straight into
+  Buffer as part of the task instead.
+
   @param  Volume                - FAT file system volume.
   @param  CacheDataType         - The type of cache: CACHE_DATA or CACHE_FAT.
   @param  IoMode                - Indicate the type of disk access.
@@ -221,6 +272,7 @@ FatGetCachePage (
   @param  Offset                - The starting byte of cache page.
   @param  Length                - The number of bytes that is read or written
   @param  Buffer                - Buffer containing cache data.
+  @param  Task                    point to task instance.
 
   @retval EFI_SUCCESS           - The data was accessed correctly.
   @return Others                - An error occurred when accessing unaligned cache page.
@@ -235,7 +287,8 @@ FatAccessUnalignedCachePage (
   IN     UINTN             PageNo,
   IN     UINTN             Offset,
   IN     UINTN             Length,
-  IN OUT VOID              *Buffer
+  IN OUT VOID              *Buffer,
+  IN     FAT_TASK          *Task
   )
 {
   EFI_STATUS  Status;
@@ -248,7 +301,19 @@ FatAccessUnalignedCachePage (
   DiskCache = &Volume->DiskCache[CacheDataType];
   GroupNo   = PageNo & DiskCache->GroupMask;
   CacheTag  = &DiskCache->CacheTag[GroupNo];
-  Status    = FatGetCachePage (Volume, CacheDataType, PageNo, CacheTag);
+  if (Task != NULL && IoMode == ReadDisk && CacheDataType == CacheData &&
+      (CacheTag->RealSize == 0 || CacheTag->PageNo != PageNo)) {
+    return FatDiskIo (
+             Volume,
+             ReadDisk,
+             DiskCache->BaseAddress + LShiftU64 (PageNo, DiskCache->PageAlignment) + Offset,
+             Length,
+             Buffer,
+             Task
+             );
+  }
+
+  Status = FatGetCachePage (Volume, CacheDataType, PageNo, CacheTag);
   if (!EFI_ERROR (Status)) {
     Source      = DiskCache->CacheBase + (GroupNo << DiskCache->PageAlignment) + Offset;
     Destination = Buffer;
@@ -334,7 +399,7 @@ FatAccessCache (
       Length = BufferSize;
     }
 
-    Status = FatAccessUnalignedCachePage (Volume, CacheDataType, IoMode, PageNo, UnderRun, Length, Buffer);
+    Status = FatAccessUnalignedCachePage (Volume, CacheDataType, IoMode, PageNo, UnderRun, Length, Buffer, Task);
     if (EFI_ERROR (Status)) {
       return Status;
     }
@@ -357,6 +422,13 @@ FatAccessCache (
 
     EntryPos    = Volume->RootPos + LShiftU64 (PageNo, PageAlignment);
     AlignedSize = AlignedPageCount << PageAlignment;
+    if (Task != NULL && IoMode == ReadDisk) {
+      Status = FatWriteBackDataCacheRange (Volume, PageNo, OverRunPageNo);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
     Status      = FatDiskIo (Volume, IoMode, EntryPos, AlignedSize, Buffer, Task);
     if (EFI_ERROR (Status)) {
       return Status;
@@ -377,7 +449,7 @@ FatAccessCache (
     //
     // Last read is not a complete page
     //
-    Status = FatAccessUnalignedCachePage (Volume, CacheDataType, IoMode, OverRunPageNo, 0, OverRun, Buffer);
+    Status = FatAccessUnalignedCachePage (Volume, CacheDataType, IoMode, OverRunPageNo, 0, OverRun, Buffer, Task);
   }
 
   return Status;
@@ -437,6 +509,137 @@ FatVolumeFlushCache (
   return Status;
 }
 
+/**
+
+  Check whether the data cache page PageNo needs to be loaded by read-ahead.
+  A page which is already cached does not, and a group holding dirty data is
+  left alone so that read-ahead never has to write anything back.
+
+  @param  DiskCache             - The data cache.
+  @param  PageNo                - The page to check.
+
+  @retval TRUE                  - The page can be loaded into its cache group.
+  @retval FALSE                 - The page does not need to be loaded.
+
+**/
+STATIC
+BOOLEAN
+FatIsReadAheadPage (
+  IN DISK_CACHE         *DiskCache,
+  IN UINTN              PageNo
+  )
+{
+  CACHE_TAG   *CacheTag;
+
+  CacheTag = &DiskCache->CacheTag[PageNo & DiskCache->GroupMask];
+  return (BOOLEAN) (CacheTag->RealSize == 0 || (CacheTag->PageNo != PageNo && !CacheTag->Dirty));
+}
+
+/**
+
+  Load the data cache pages which cover the specified disk range,
+  using as few disk reads as possible.
+
+  Consecutive pages map to consecutive cache groups, so each run of pages
+  which are missing from the cache is read with a single disk access
+  straight into the cache buffer instead of one access per page.
+
+  @param  Volume                - FAT file system volume.
+  @param  Offset                - The starting byte offset of the range.
+  @param  Length                - The length of the range in bytes.
+
+  @retval EFI_SUCCESS           - The pages are loaded, or nothing needs to be loaded.
+  @return Others                - An error occurred when reading the disk.
+
+**/
+EFI_STATUS
+FatPrefetchDataCache (
+  IN FAT_VOLUME         *Volume,
+  IN UINT64             Offset,
+  IN UINTN              Length
+  )
+{
+  EFI_STATUS  Status;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *CacheTag;
+  UINTN       PageNo;
+  UINTN       EndPageNo;
+  UINTN       RunPageNo;
+  UINTN       GroupMask;
+  UINTN       PageSize;
+  UINTN       ReadSize;
+  UINTN       Remaining;
+  UINT64      EntryPos;
+  UINT8       PageAlignment;
+
+  DiskCache     = &Volume->DiskCache[CacheData];
+  GroupMask     = DiskCache->GroupMask;
+  PageAlignment = DiskCache->PageAlignment;
+  PageSize      = (UINTN)1 << PageAlignment;
+
+  if (Length == 0 || Offset < DiskCache->BaseAddress || Offset >= DiskCache->LimitAddress) {
+    return EFI_SUCCESS;
+  }
+
+  if (Length > DiskCache->LimitAddress - Offset) {
+    Length = (UINTN) (DiskCache->LimitAddress - Offset);
+  }
+
+  EntryPos  = Offset - DiskCache->BaseAddress;
+  PageNo    = (UINTN) RShiftU64 (EntryPos, PageAlignment);
+  EndPageNo = (UINTN) RShiftU64 (EntryPos + Length - 1, PageAlignment) + 1;
+  //
+  // Never load more pages than the cache holds, or the range would evict itself
+  //
+  if (EndPageNo - PageNo > GroupMask + 1) {
+    EndPageNo = PageNo + GroupMask + 1;
+  }
+
+  while (PageNo < EndPageNo) {
+    if (!FatIsReadAheadPage (DiskCache, PageNo)) {
+      PageNo++;
+      continue;
+    }
+    //
+    // Collect the run of pages to load. The run stops where the cache
+    // buffer wraps around, so it is contiguous in memory as well.
+    //
+    RunPageNo = PageNo;
+    do {
+      DiskCache->CacheTag[PageNo & GroupMask].RealSize = 0;
+      PageNo++;
+    } while (PageNo < EndPageNo && (PageNo & GroupMask) != 0 && FatIsReadAheadPage (DiskCache, PageNo));
+
+    EntryPos = DiskCache->BaseAddress + LShiftU64 (RunPageNo, PageAlignment);
+    ReadSize = (PageNo - RunPageNo) << PageAlignment;
+    if (ReadSize > DiskCache->LimitAddress - EntryPos) {
+      ReadSize = (UINTN) (DiskCache->LimitAddress - EntryPos);
+    }
+
+    Status = FatDiskIo (
+               Volume,
+               ReadDisk,
+               EntryPos,
+               ReadSize,
+               DiskCache->CacheBase + ((RunPageNo & GroupMask) << PageAlignment),
+               NULL
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    for (Remaining = ReadSize; RunPageNo < PageNo; RunPageNo++) {
+      CacheTag            = &DiskCache->CacheTag[RunPageNo & GroupMask];
+      CacheTag->PageNo    = RunPageNo;
+      CacheTag->Dirty     = FALSE;
+      CacheTag->RealSize  = Remaining < PageSize ? Remaining : PageSize;
+      Remaining          -= CacheTag->RealSize;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
 
   Initialize the disk cache according to Volume's FatType.
@@ -87,6 +87,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define FAT_DATACACHE_PAGE_MIN_ALIGNMENT  13
 #define FAT_DATACACHE_PAGE_MAX_ALIGNMENT  16
 #define FAT_DATACACHE_GROUP_COUNT         64
+#define FAT_DATACACHE_READ_AHEAD_PAGES    16
 #define FAT_FATCACHE_GROUP_MIN_COUNT      1
 #define FAT_FATCACHE_GROUP_MAX_COUNT      16
 
@@ -110,8 +111,9 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define LC_ISO_639_2_ENTRY_SIZE 3
 #define MAX_LANG_CODE_SIZE      100
 
-#define FAT_MAX_DIR_CACHE_COUNT 8
 #define FAT_MAX_DIRENTRY_COUNT  0xFFFF
+#define FAT_MIN_EXTENT_COUNT    8
+#define FAT_MAX_EXTENT_COUNT    1024
 typedef CHAR8                   LC_ISO_639_2;
 
 //
@@ -166,10 +168,11 @@ typedef struct {
 } DISK_CACHE;
 
 //
-// Hash table size
+// Hash table size. The tables of a directory start at HASH_TABLE_SIZE
+// buckets and double whenever they hold more entries than buckets.
 //
-#define HASH_TABLE_SIZE  0x400
-#define HASH_TABLE_MASK  (HASH_TABLE_SIZE - 1)
+#define HASH_TABLE_SIZE      0x400
+#define HASH_TABLE_MAX_SIZE  0x10000
 
 //
 // The directory entry for opened directory
@@ -202,10 +205,21 @@ struct _FAT_ODIR {
   BOOLEAN             EndOfDir;               // Indicate whether we have reached the end of the directory
   LIST_ENTRY          DirCacheLink;           // Linked in Volume->DirCacheList when discarded
   UINTN               DirCacheTag;            // The identification of the directory when in directory cache
-  FAT_DIRENT          *LongNameHashTable[HASH_TABLE_SIZE];
-  FAT_DIRENT          *ShortNameHashTable[HASH_TABLE_SIZE];
+  UINTN               HashTableMask;          // Number of buckets in each hash table minus 1
+  UINTN               HashEntryCount;         // Number of directory entries in the hash tables
+  FAT_DIRENT          **LongNameHashTable;
+  FAT_DIRENT          **ShortNameHashTable;
 };
 
+//
+// One run of consecutive clusters of a file
+//
+typedef struct {
+  UINTN               FileCluster;            // Index of the first cluster of the run within the file
+  UINTN               Cluster;                // First cluster of the run on the disk
+  UINTN               Count;                  // Number of clusters in the run
+} FAT_EXTENT;
+
 typedef struct {
   UINTN               Signature;
   EFI_FILE_PROTOCOL   Handle;
@@ -258,6 +272,13 @@ struct _FAT_OFILE {
   UINTN               FileCluster;
   UINTN               FileCurrentCluster;
   UINTN               FileLastCluster;
+  //
+  // The runs of the cluster chain mapped so far, in file order. They are
+  // built lazily from the start of the chain and dropped when it changes.
+  //
+  FAT_EXTENT          *Extents;
+  UINTN               ExtentCount;
+  UINTN               ExtentCapacity;
 
   //
   // Dirty is set if there have been any updates to the
@@ -278,6 +299,11 @@ struct _FAT_OFILE {
   UINT64              PosDisk;  // on the disk
   UINTN               PosRem;   // remaining in this disk run
   //
+  // Sequential read detection for the data cache read-ahead
+  //
+  UINTN               ReadAheadPosition;  // file position the next sequential read starts at
+  UINTN               ReadAheadSize;      // bytes to load ahead of a sequential read, 0 if none
+  //
   // The opened parent, full path length and currently opened child files
   //
   FAT_OFILE           *Parent;
@@ -774,6 +800,26 @@ FatVolumeFlushCache (
   IN FAT_TASK                *Task
   );
 
+/**
+
+  Load the data cache pages which cover the specified disk range,
+  using as few disk reads as possible.
+
+  @param  Volume                - FAT file system volume.
+  @param  Offset                - The starting byte offset of the range.
+  @param  Length                - The length of the range in bytes.
+
+  @retval EFI_SUCCESS           - The pages are loaded, or nothing needs to be loaded.
+  @return Others                - An error occurred when reading the disk.
+
+**/
+EFI_STATUS
+FatPrefetchDataCache (
+  IN FAT_VOLUME              *Volume,
+  IN UINT64                  Offset,
+  IN UINTN                   Length
+  );
+
 //
 // Flush.c
 //
@@ -952,6 +998,18 @@ FatOFilePosition (
   IN UINTN                PosLimit
   );
 
+/**
+
+  Free the cluster run map of the open file.
+
+  @param  OFile                 - The open file.
+
+**/
+VOID
+FatFreeExtents (
+  IN FAT_OFILE            *OFile
+  );
+
 /**
 
   Update the free cluster info of FatInfoSector of the volume.
@@ -1797,6 +1855,33 @@ FatShortNameHashSearch (
   IN CHAR8              *ShortNameString
   );
 
+/**
+
+  Allocate the initial hash tables of the directory.
+
+  @param  ODir                  - The directory.
+
+  @retval EFI_SUCCESS           - The hash tables are allocated.
+  @retval EFI_OUT_OF_RESOURCES  - Not enough memory to allocate the hash tables.
+
+**/
+EFI_STATUS
+FatCreateHashTable (
+  IN FAT_ODIR           *ODir
+  );
+
+/**
+
+  Free the hash tables of the directory.
+
+  @param  ODir                  - The directory.
+
+**/
+VOID
+FatFreeHashTable (
+  IN FAT_ODIR           *ODir
+  );
+
 /**
 
   Insert directory entry to hash table.
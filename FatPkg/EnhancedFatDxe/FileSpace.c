@@ -405,9 +405,11 @@ FatShrinkEof (
   //
   // Set CurrentCluster == FileCluster
   // to force a recalculation of Position related stuffs
+  // and drop the cluster runs which may refer to freed clusters
   //
   OFile->FileCurrentCluster = OFile->FileCluster;
   OFile->FileLastCluster    = LastCluster;
+  OFile->ExtentCount        = 0;
   OFile->Dirty              = TRUE;
   //
   // Free the remaining cluster chain
@@ -549,6 +551,160 @@ Done:
   return Status;
 }
 
+/**
+
+  Free the cluster run map of the open file.
+
+  @param  OFile                 - The open file.
+
+**/
+VOID
+FatFreeExtents (
+  IN FAT_OFILE            *OFile
+  )
+{
+  if (OFile->Extents != NULL) {
+    FreePool (OFile->Extents);
+    OFile->Extents = NULL;
+  }
+
+  OFile->ExtentCount    = 0;
+  OFile->ExtentCapacity = 0;
+}
+
+/**
+
+  Extend the cluster run map of the open file until it covers the cluster
+  ClusterIndex of the file, and the run containing it is mapped either up
+  to its end or beyond the cluster ClusterLimit of the file.
+
+  The map only ever grows at its end, by following the cluster chain from
+  the last mapped cluster, so each FAT entry of the file is read once
+  however the file is accessed. Clusters appended to the chain by
+  FatGrowEof() are picked up the same way.
+
+  @param  OFile                 - The open file.
+  @param  ClusterIndex          - The cluster of the file which must be mapped.
+  @param  ClusterLimit          - The last cluster of the file the caller is interested in.
+
+  @retval EFI_SUCCESS           - The cluster is mapped.
+  @retval EFI_OUT_OF_RESOURCES  - The map cannot grow any further.
+  @retval EFI_VOLUME_CORRUPTED  - Cluster chain corrupt.
+
+**/
+STATIC
+EFI_STATUS
+FatMapExtents (
+  IN FAT_OFILE            *OFile,
+  IN UINTN                ClusterIndex,
+  IN UINTN                ClusterLimit
+  )
+{
+  FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
+  FAT_EXTENT  *NewExtents;
+  UINTN       NewCapacity;
+  UINTN       Index;
+  UINTN       Cluster;
+
+  Volume = OFile->Volume;
+
+  for (;;) {
+    if (OFile->ExtentCount == 0) {
+      Extent  = NULL;
+      Index   = 0;
+      Cluster = OFile->FileCluster;
+    } else {
+      Extent  = &OFile->Extents[OFile->ExtentCount - 1];
+      Index   = Extent->FileCluster + Extent->Count;
+      if (Index > ClusterLimit) {
+        return EFI_SUCCESS;
+      }
+
+      Cluster = FatGetFatEntry (Volume, Extent->Cluster + Extent->Count - 1);
+      if (Index > ClusterIndex && Cluster != Extent->Cluster + Extent->Count) {
+        //
+        // The run containing ClusterIndex ends here
+        //
+        return EFI_SUCCESS;
+      }
+    }
+
+    if (Cluster < FAT_MIN_CLUSTER || Cluster > Volume->MaxCluster + 1) {
+      DEBUG ((EFI_D_INIT | EFI_D_ERROR, "FatMapExtents: cluster chain corrupt\n"));
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    if (Extent != NULL && Cluster == Extent->Cluster + Extent->Count) {
+      Extent->Count++;
+      continue;
+    }
+
+    if (OFile->ExtentCount == OFile->ExtentCapacity) {
+      if (OFile->ExtentCapacity >= FAT_MAX_EXTENT_COUNT) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+
+      NewCapacity = OFile->ExtentCapacity == 0 ? FAT_MIN_EXTENT_COUNT : OFile->ExtentCapacity * 2;
+      NewExtents  = ReallocatePool (
+                      OFile->ExtentCapacity * sizeof (FAT_EXTENT),
+                      NewCapacity * sizeof (FAT_EXTENT),
+                      OFile->Extents
+                      );
+      if (NewExtents == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+
+      OFile->Extents        = NewExtents;
+      OFile->ExtentCapacity = NewCapacity;
+    }
+
+    Extent              = &OFile->Extents[OFile->ExtentCount++];
+    Extent->FileCluster = Index;
+    Extent->Cluster     = Cluster;
+    Extent->Count       = 1;
+  }
+}
+
+/**
+
+  Find the cluster run which contains the cluster ClusterIndex of the file.
+  The cluster must have been mapped by FatMapExtents().
+
+  @param  OFile                 - The open file.
+  @param  ClusterIndex          - The cluster of the file.
+
+  @return The cluster run containing the cluster.
+
+**/
+STATIC
+FAT_EXTENT *
+FatFindExtent (
+  IN FAT_OFILE            *OFile,
+  IN UINTN                ClusterIndex
+  )
+{
+  UINTN       Low;
+  UINTN       High;
+  UINTN       Middle;
+
+  ASSERT (OFile->ExtentCount > 0);
+
+  Low  = 0;
+  High = OFile->ExtentCount - 1;
+  while (Low < High) {
+    Middle = (Low + High + 1) / 2;
+    if (OFile->Extents[Middle].FileCluster <= ClusterIndex) {
+      Low = Middle;
+    } else {
+      High = Middle - 1;
+    }
+  }
+
+  ASSERT (ClusterIndex - OFile->Extents[Low].FileCluster < OFile->Extents[Low].Count);
+  return &OFile->Extents[Low];
+}
+
 /**
 
   Seek OFile to requested position, and calculate the number of
@@ -569,8 +725,11 @@ FatOFilePosition (
   IN UINTN                PosLimit
   )
 {
+  EFI_STATUS  Status;
   FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
   UINTN       ClusterSize;
+  UINTN       ClusterIndex;
   UINTN       Cluster;
   UINTN       StartPos;
   UINTN       Run;
@@ -580,6 +739,36 @@ FatOFilePosition (
 
   ASSERT_VOLUME_LOCKED (Volume);
 
+  Status = EFI_NOT_FOUND;
+  if (!OFile->IsFixedRootDir) {
+    //
+    // Look the position up in the cluster run map first
+    //
+    ClusterIndex = Position >> Volume->ClusterAlignment;
+    Status       = FatMapExtents (
+                     OFile,
+                     ClusterIndex,
+                     (Position + (PosLimit > 0 ? PosLimit - 1 : 0)) >> Volume->ClusterAlignment
+                     );
+    if (Status == EFI_VOLUME_CORRUPTED) {
+      return Status;
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Extent    = FatFindExtent (OFile, ClusterIndex);
+      Cluster   = Extent->Cluster + (ClusterIndex - Extent->FileCluster);
+      StartPos  = ClusterIndex << Volume->ClusterAlignment;
+
+      OFile->PosDisk            = Volume->FirstClusterPos +
+                                  LShiftU64 (Cluster - FAT_MIN_CLUSTER, Volume->ClusterAlignment) +
+                                  Position - StartPos;
+      OFile->FileCurrentCluster = Cluster;
+      OFile->Position           = StartPos;
+      Run                       = ((Extent->FileCluster + Extent->Count - ClusterIndex) << Volume->ClusterAlignment) -
+                                  (Position - StartPos);
+    }
+  }
+
   //
   // If this is the fixed root dir, then compute it's position
   // from it's fixed info in the fat bpb
@@ -587,7 +776,7 @@ FatOFilePosition (
   if (OFile->IsFixedRootDir) {
     OFile->PosDisk  = Volume->RootPos + Position;
     Run             = OFile->FileSize - Position;
-  } else {
+  } else if (EFI_ERROR (Status)) {
     //
     // Run the file's cluster chain to find the current position
     // If possible, run from the current cluster rather than
@@ -39,7 +39,7 @@ FatHashLongName (
     );
   FatStrUpr (UpCasedLongFileName);
   gBS->CalculateCrc32 (UpCasedLongFileName, StrSize (UpCasedLongFileName), &HashValue);
-  return (HashValue & HASH_TABLE_MASK);
+  return HashValue;
 }
 
 /**
@@ -59,7 +59,7 @@ FatHashShortName (
 {
   UINT32  HashValue;
   gBS->CalculateCrc32 (ShortNameString, FAT_NAME_LEN, &HashValue);
-  return (HashValue & HASH_TABLE_MASK);
+  return HashValue;
 }
 
 /**
@@ -79,7 +79,7 @@ FatLongNameHashSearch (
   )
 {
   FAT_DIRENT  **PreviousHashNode;
-  for (PreviousHashNode   = &ODir->LongNameHashTable[FatHashLongName (LongNameString)];
+  for (PreviousHashNode   = &ODir->LongNameHashTable[FatHashLongName (LongNameString) & ODir->HashTableMask];
        *PreviousHashNode != NULL;
        PreviousHashNode   = &(*PreviousHashNode)->LongNameForwardLink
       ) {
@@ -108,7 +108,7 @@ FatShortNameHashSearch (
   )
 {
   FAT_DIRENT  **PreviousHashNode;
-  for (PreviousHashNode   = &ODir->ShortNameHashTable[FatHashShortName (ShortNameString)];
+  for (PreviousHashNode   = &ODir->ShortNameHashTable[FatHashShortName (ShortNameString) & ODir->HashTableMask];
        *PreviousHashNode != NULL;
        PreviousHashNode   = &(*PreviousHashNode)->ShortNameForwardLink
       ) {
@@ -120,6 +120,109 @@ FatShortNameHashSearch (
   return PreviousHashNode;
 }
 
+/**
+
+  Allocate the initial hash tables of the directory.
+
+  @param  ODir                  - The directory.
+
+  @retval EFI_SUCCESS           - The hash tables are allocated.
+  @retval EFI_OUT_OF_RESOURCES  - Not enough memory to allocate the hash tables.
+
+**/
+EFI_STATUS
+FatCreateHashTable (
+  IN FAT_ODIR     *ODir
+  )
+{
+  FAT_DIRENT  **HashTable;
+
+  HashTable = AllocateZeroPool (2 * HASH_TABLE_SIZE * sizeof (FAT_DIRENT *));
+  if (HashTable == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ODir->HashTableMask       = HASH_TABLE_SIZE - 1;
+  ODir->HashEntryCount      = 0;
+  ODir->LongNameHashTable   = HashTable;
+  ODir->ShortNameHashTable  = HashTable + HASH_TABLE_SIZE;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Free the hash tables of the directory.
+
+  @param  ODir                  - The directory.
+
+**/
+VOID
+FatFreeHashTable (
+  IN FAT_ODIR     *ODir
+  )
+{
+  //
+  // Both tables live in one allocation which starts with the long name table
+  //
+  if (ODir->LongNameHashTable != NULL) {
+    FreePool (ODir->LongNameHashTable);
+    ODir->LongNameHashTable   = NULL;
+    ODir->ShortNameHashTable  = NULL;
+  }
+}
+
+/**
+
+  Double the number of buckets of the hash tables of the directory and
+  rehash all the directory entries. The directory keeps its current tables
+  if the memory for the new ones cannot be allocated.
+
+  @param  ODir                  - The directory.
+
+**/
+STATIC
+VOID
+FatGrowHashTable (
+  IN FAT_ODIR     *ODir
+  )
+{
+  FAT_DIRENT  **LongNameHashTable;
+  FAT_DIRENT  **ShortNameHashTable;
+  FAT_DIRENT  *DirEnt;
+  FAT_DIRENT  *NextDirEnt;
+  UINTN       NewMask;
+  UINTN       Index;
+  UINT32      HashTableIndex;
+
+  NewMask           = ODir->HashTableMask * 2 + 1;
+  LongNameHashTable = AllocateZeroPool (2 * (NewMask + 1) * sizeof (FAT_DIRENT *));
+  if (LongNameHashTable == NULL) {
+    return;
+  }
+
+  ShortNameHashTable = LongNameHashTable + NewMask + 1;
+  for (Index = 0; Index <= ODir->HashTableMask; Index++) {
+    for (DirEnt = ODir->ShortNameHashTable[Index]; DirEnt != NULL; DirEnt = NextDirEnt) {
+      NextDirEnt                          = DirEnt->ShortNameForwardLink;
+      HashTableIndex                      = FatHashShortName (DirEnt->Entry.FileName) & NewMask;
+      DirEnt->ShortNameForwardLink        = ShortNameHashTable[HashTableIndex];
+      ShortNameHashTable[HashTableIndex]  = DirEnt;
+    }
+
+    for (DirEnt = ODir->LongNameHashTable[Index]; DirEnt != NULL; DirEnt = NextDirEnt) {
+      NextDirEnt                          = DirEnt->LongNameForwardLink;
+      HashTableIndex                      = FatHashLongName (DirEnt->FileString) & NewMask;
+      DirEnt->LongNameForwardLink         = LongNameHashTable[HashTableIndex];
+      LongNameHashTable[HashTableIndex]   = DirEnt;
+    }
+  }
+
+  FatFreeHashTable (ODir);
+  ODir->HashTableMask       = NewMask;
+  ODir->LongNameHashTable   = LongNameHashTable;
+  ODir->ShortNameHashTable  = ShortNameHashTable;
+}
+
 /**
 
   Insert directory entry to hash table.
@@ -137,17 +240,22 @@ FatInsertToHashTable (
   FAT_DIRENT  **HashTable;
   UINT32      HashTableIndex;
 
+  if (ODir->HashEntryCount > ODir->HashTableMask && ODir->HashTableMask < HASH_TABLE_MAX_SIZE - 1) {
+    FatGrowHashTable (ODir);
+  }
+
+  ODir->HashEntryCount++;
   //
   // Insert hash table index for short name
   //
-  HashTableIndex                = FatHashShortName (DirEnt->Entry.FileName);
+  HashTableIndex                = FatHashShortName (DirEnt->Entry.FileName) & (UINT32) ODir->HashTableMask;
   HashTable                     = ODir->ShortNameHashTable;
   DirEnt->ShortNameForwardLink  = HashTable[HashTableIndex];
   HashTable[HashTableIndex]     = DirEnt;
   //
   // Insert hash table index for long name
   //
-  HashTableIndex                = FatHashLongName (DirEnt->FileString);
+  HashTableIndex                = FatHashLongName (DirEnt->FileString) & (UINT32) ODir->HashTableMask;
   HashTable                     = ODir->LongNameHashTable;
   DirEnt->LongNameForwardLink   = HashTable[HashTableIndex];
   HashTable[HashTableIndex]     = DirEnt;
@@ -169,4 +277,5 @@ FatDeleteFromHashTable (
 {
   *FatShortNameHashSearch (ODir, DirEnt->Entry.FileName) = DirEnt->ShortNameForwardLink;
   *FatLongNameHashSearch (ODir, DirEnt->FileString)      = DirEnt->LongNameForwardLink;
+  ODir->HashEntryCount--;
 }
@@ -298,6 +298,52 @@ FatOnAccessComplete (
   }
 }
 
+/**
+
+  Try to merge a non-blocking disk access into the last subtask of the task.
+
+  The subtasks of a task are only submitted by FatQueueTask(), so an access
+  which continues the last one both on the disk and in memory can simply
+  extend it. This way a file request that is split into cache pages and
+  cluster runs ends up with one disk request per contiguous disk range.
+
+  @param  Task                  - The task the access belongs to.
+  @param  IoMode                - The access mode (ReadDisk or WriteDisk).
+  @param  Offset                - The starting byte offset of the access.
+  @param  BufferSize            - Size of Buffer.
+  @param  Buffer                - Buffer of the access.
+
+  @retval TRUE                  - The access was merged into the last subtask.
+  @retval FALSE                 - A new subtask is needed for the access.
+
+**/
+STATIC
+BOOLEAN
+FatMergeSubtask (
+  IN FAT_TASK         *Task,
+  IN IO_MODE          IoMode,
+  IN UINT64           Offset,
+  IN UINTN            BufferSize,
+  IN VOID             *Buffer
+  )
+{
+  FAT_SUBTASK         *Subtask;
+
+  if (IsListEmpty (&Task->Subtasks)) {
+    return FALSE;
+  }
+
+  Subtask = CR (Task->Subtasks.BackLink, FAT_SUBTASK, Link, FAT_SUBTASK_SIGNATURE);
+  if ((Subtask->Write != (BOOLEAN) (IoMode == WriteDisk)) ||
+      (Subtask->Offset + Subtask->BufferSize != Offset) ||
+      ((UINT8 *) Subtask->Buffer + Subtask->BufferSize != (UINT8 *) Buffer)) {
+    return FALSE;
+  }
+
+  Subtask->BufferSize += BufferSize;
+  return TRUE;
+}
+
 /**
 
   General disk access function.
@@ -350,6 +396,11 @@ FatDiskIo (
         DiskIo      = Volume->DiskIo;
         IoFunction  = (IoMode == ReadDisk) ? DiskIo->ReadDisk : DiskIo->WriteDisk;
         Status      = IoFunction (DiskIo, Volume->MediaId, Offset, BufferSize, Buffer);
+      } else if (FatMergeSubtask (Task, IoMode, Offset, BufferSize, Buffer)) {
+        //
+        // Merged into the previous non-blocking access
+        //
+        Status = EFI_SUCCESS;
       } else {
         //
         // Non-blocking access
@@ -471,17 +471,41 @@ FatAccessOFile (
   UINTN       Len;
   EFI_STATUS  Status;
   UINTN       BufferSize;
+  UINTN       PageSize;
+  UINTN       ReadAhead;
 
   BufferSize  = *DataBufferSize;
   Volume      = OFile->Volume;
   ASSERT_VOLUME_LOCKED (Volume);
 
+  //
+  // Reads smaller than a data cache page are served by the data cache one page
+  // at a time. When such reads walk through the file sequentially, load a
+  // growing window of pages ahead with one disk read instead.
+  //
+  ReadAhead = 0;
+  if (IoMode == ReadData && Task == NULL) {
+    PageSize = (UINTN)1 << Volume->DiskCache[CacheData].PageAlignment;
+    if (Position == OFile->ReadAheadPosition && BufferSize < PageSize) {
+      if (OFile->ReadAheadSize == 0) {
+        OFile->ReadAheadSize = PageSize * 2;
+      } else if (OFile->ReadAheadSize < PageSize * FAT_DATACACHE_READ_AHEAD_PAGES) {
+        OFile->ReadAheadSize *= 2;
+      }
+    } else {
+      OFile->ReadAheadSize = 0;
+    }
+
+    ReadAhead                = OFile->ReadAheadSize;
+    OFile->ReadAheadPosition = Position + BufferSize;
+  }
+
   Status = EFI_SUCCESS;
   while (BufferSize > 0) {
     //
     // Seek the OFile to the file position
     //
-    Status = FatOFilePosition (OFile, Position, BufferSize);
+    Status = FatOFilePosition (OFile, Position, BufferSize > ReadAhead ? BufferSize : ReadAhead);
     if (EFI_ERROR (Status)) {
       break;
     }
@@ -490,6 +514,14 @@ FatAccessOFile (
     //
     Len = BufferSize > OFile->PosRem ? OFile->PosRem : BufferSize;
 
+    if (ReadAhead > 0) {
+      //
+      // A failed read-ahead is not fatal, the read below loads what it needs.
+      //
+      FatPrefetchDataCache (Volume, OFile->PosDisk, ReadAhead > OFile->PosRem ? OFile->PosRem : ReadAhead);
+      ReadAhead = 0;
+    }
+
     //
     // Write the data
     //
@@ -1234,28 +1234,25 @@ AhciStopCommand (
 }
 
 /**
-  Start command for give slot on specific port.
+  Start the command list processing of specific port.
 
   @param  PciIo              The PCI IO protocol instance.
   @param  Port               The number of port.
-  @param  CommandSlot        The number of Command Slot.
   @param  Timeout            The timeout value of start, uses 100ns as a unit.
 
-  @retval EFI_DEVICE_ERROR   The command start unsuccessfully.
+  @retval EFI_DEVICE_ERROR   The port start unsuccessfully.
   @retval EFI_TIMEOUT        The operation is time out.
-  @retval EFI_SUCCESS        The command start successfully.
+  @retval EFI_SUCCESS        The port start successfully.
 
 **/
 EFI_STATUS
 EFIAPI
-AhciStartCommand (
+AhciStartPort (
   IN  EFI_PCI_IO_PROTOCOL       *PciIo,
   IN  UINT8                     Port,
-  IN  UINT8                     CommandSlot,
   IN  UINT64                    Timeout
   )
 {
-  UINT32     CmdSlotBit;
   EFI_STATUS Status;
   UINT32     PortStatus;
   UINT32     StartCmd;
@@ -1268,8 +1265,6 @@ AhciStartCommand (
   //
   Capability = AhciReadReg(PciIo, EFI_AHCI_CAPABILITY_OFFSET);
 
-  CmdSlotBit = (UINT32) (1 << CommandSlot);
-
   AhciClearPortStatus (
     PciIo,
     Port
@@ -1316,6 +1311,42 @@ AhciStartCommand (
   Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_CMD;
   AhciOrReg (PciIo, Offset, EFI_AHCI_PORT_CMD_ST | StartCmd);
 
+  return EFI_SUCCESS;
+}
+
+/**
+  Start command for give slot on specific port.
+
+  @param  PciIo              The PCI IO protocol instance.
+  @param  Port               The number of port.
+  @param  CommandSlot        The number of Command Slot.
+  @param  Timeout            The timeout value of start, uses 100ns as a unit.
+
+  @retval EFI_DEVICE_ERROR   The command start unsuccessfully.
+  @retval EFI_TIMEOUT        The operation is time out.
+  @retval EFI_SUCCESS        The command start successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciStartCommand (
+  IN  EFI_PCI_IO_PROTOCOL       *PciIo,
+  IN  UINT8                     Port,
+  IN  UINT8                     CommandSlot,
+  IN  UINT64                    Timeout
+  )
+{
+  UINT32     CmdSlotBit;
+  EFI_STATUS Status;
+  UINT32     Offset;
+
+  CmdSlotBit = (UINT32) (1 << CommandSlot);
+
+  Status = AhciStartPort (PciIo, Port, Timeout);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   //
   // Setting the command
   //
@@ -1866,6 +1897,86 @@ AhciPacketCommandExecute (
   return Status;
 }
 
+/**
+  Allocate one command table per command slot for queued (FPDMA) commands.
+
+  The tables are optional. If they can not be allocated, AhciNcqCommandTable
+  is left NULL and queued commands are rejected with EFI_UNSUPPORTED.
+
+  @param  PciIo                 The PCI IO protocol instance.
+  @param  AhciRegisters         The pointer to the EFI_AHCI_REGISTERS.
+  @param  SlotNumber            The number of command slots per port.
+  @param  Support64Bit          Whether the HBA supports 64-bit addressing.
+
+**/
+VOID
+EFIAPI
+AhciCreateNcqCommandTable (
+  IN     EFI_PCI_IO_PROTOCOL    *PciIo,
+  IN OUT EFI_AHCI_REGISTERS     *AhciRegisters,
+  IN     UINT8                  SlotNumber,
+  IN     BOOLEAN                Support64Bit
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 Bytes;
+  VOID                  *Buffer;
+  UINT64                MaxNcqCommandTableSize;
+  EFI_PHYSICAL_ADDRESS  AhciNcqCommandTablePciAddr;
+
+  AhciRegisters->AhciNcqCommandTable = NULL;
+  AhciRegisters->NcqSlotNumber       = 0;
+
+  //
+  // The size of EFI_AHCI_NCQ_COMMAND_TABLE is a multiple of 128 bytes, so every
+  // table in the array meets the command table base address alignment.
+  //
+  Buffer = NULL;
+  MaxNcqCommandTableSize = SlotNumber * sizeof (EFI_AHCI_NCQ_COMMAND_TABLE);
+
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    EFI_SIZE_TO_PAGES ((UINTN) MaxNcqCommandTableSize),
+                    &Buffer,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  ZeroMem (Buffer, (UINTN)MaxNcqCommandTableSize);
+
+  Bytes  = (UINTN)MaxNcqCommandTableSize;
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    Buffer,
+                    &Bytes,
+                    &AhciNcqCommandTablePciAddr,
+                    &AhciRegisters->MapNcqCommandTable
+                    );
+  if (EFI_ERROR (Status) || (Bytes != MaxNcqCommandTableSize)) {
+    if (!EFI_ERROR (Status)) {
+      PciIo->Unmap (PciIo, AhciRegisters->MapNcqCommandTable);
+    }
+    PciIo->FreeBuffer (PciIo, EFI_SIZE_TO_PAGES ((UINTN) MaxNcqCommandTableSize), Buffer);
+    return;
+  }
+
+  if ((!Support64Bit) && (AhciNcqCommandTablePciAddr > 0x100000000ULL)) {
+    PciIo->Unmap (PciIo, AhciRegisters->MapNcqCommandTable);
+    PciIo->FreeBuffer (PciIo, EFI_SIZE_TO_PAGES ((UINTN) MaxNcqCommandTableSize), Buffer);
+    return;
+  }
+
+  AhciRegisters->AhciNcqCommandTable        = Buffer;
+  AhciRegisters->AhciNcqCommandTablePciAddr = (EFI_AHCI_NCQ_COMMAND_TABLE *)(UINTN)AhciNcqCommandTablePciAddr;
+  AhciRegisters->MaxNcqCommandTableSize     = MaxNcqCommandTableSize;
+  AhciRegisters->NcqSlotNumber              = SlotNumber;
+}
+
 /**
   Allocate transfer-related data struct which is used at AHCI mode.
 
@@ -2073,6 +2184,16 @@ AhciCreateTransferDescriptor (
   }
   AhciRegisters->AhciCommandTablePciAddr = (EFI_AHCI_COMMAND_TABLE *)(UINTN)AhciCommandTablePciAddr;
 
+  //
+  // Allocate the command tables used by queued commands if the HBA supports
+  // native command queuing.
+  //
+  AhciRegisters->AhciNcqCommandTable = NULL;
+  AhciRegisters->NcqSlotNumber       = 0;
+  if ((Capability & EFI_AHCI_CAP_SNCQ) != 0) {
+    AhciCreateNcqCommandTable (PciIo, AhciRegisters, MaxCommandSlotNumber, Support64Bit);
+  }
+
   return EFI_SUCCESS;
   //
   // Map error or unable to map the whole CmdList buffer into a contiguous region.
@@ -2175,6 +2296,473 @@ AhciReadLogExt (
            );
 }
 
+/**
+  Issue a queued (FPDMA) command in the given command slot.
+
+  @param  Instance            The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param  AhciRegisters       The pointer to the EFI_AHCI_REGISTERS.
+  @param  Port                The number of port.
+  @param  PortMultiplier      The number of port multiplier.
+  @param  Read                The transfer direction.
+  @param  AtaCommandBlock     The EFI_ATA_COMMAND_BLOCK data.
+  @param  CommandSlot         The command slot, which is also the tag of the command.
+  @param  DataPhysicalAddr    The pci bus master address of the data buffer.
+  @param  DataCount           The data count to be transferred.
+  @param  Timeout             The timeout value of port start, uses 100ns as a unit.
+
+  @retval EFI_SUCCESS         The command is issued.
+  @retval others              The port could not be started.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciIssueQueuedCommand (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE *Instance,
+  IN EFI_AHCI_REGISTERS           *AhciRegisters,
+  IN UINT8                        Port,
+  IN UINT8                        PortMultiplier,
+  IN BOOLEAN                      Read,
+  IN EFI_ATA_COMMAND_BLOCK        *AtaCommandBlock,
+  IN UINT8                        CommandSlot,
+  IN EFI_PHYSICAL_ADDRESS         DataPhysicalAddr,
+  IN UINT32                       DataCount,
+  IN UINT64                       Timeout
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_PCI_IO_PROTOCOL         *PciIo;
+  EFI_AHCI_NCQ_COMMAND_TABLE  *CommandTable;
+  EFI_AHCI_COMMAND_LIST       *CommandList;
+  UINT32                      PrdtNumber;
+  UINT32                      PrdtIndex;
+  UINT32                      RemainedData;
+  EFI_PHYSICAL_ADDRESS        MemAddr;
+  DATA_64                     Data64;
+  UINT32                      Offset;
+  UINT32                      CmdSlotBit;
+
+  PciIo        = Instance->PciIo;
+  CommandTable = &AhciRegisters->AhciNcqCommandTable[CommandSlot];
+  CommandList  = &AhciRegisters->AhciCmdList[CommandSlot];
+  CmdSlotBit   = (UINT32) (1 << CommandSlot);
+  PrdtNumber   = (UINT32)DivU64x32 (((UINT64)DataCount + EFI_AHCI_MAX_DATA_PER_PRDT - 1), EFI_AHCI_MAX_DATA_PER_PRDT);
+  ASSERT (PrdtNumber <= EFI_AHCI_NCQ_MAX_PRDT_NUMBER);
+
+  ZeroMem (CommandTable, sizeof (EFI_AHCI_NCQ_COMMAND_TABLE));
+
+  //
+  // The tag of a queued command is carried in bits 7:3 of the sector count
+  // register, and bit 6 of the device register must be set. The FUA bit is
+  // taken from the caller as is.
+  //
+  AhciBuildCommandFis (&CommandTable->CommandFis, AtaCommandBlock);
+  CommandTable->CommandFis.AhciCFisSecCount = (UINT8) (CommandSlot << 3);
+  CommandTable->CommandFis.AhciCFisDevHead  = (UINT8) (AtaCommandBlock->AtaDeviceHead | BIT6);
+  CommandTable->CommandFis.AhciCFisPmNum    = PortMultiplier;
+
+  RemainedData = DataCount;
+  MemAddr      = DataPhysicalAddr;
+  for (PrdtIndex = 0; PrdtIndex < PrdtNumber; PrdtIndex++) {
+    if (RemainedData < EFI_AHCI_MAX_DATA_PER_PRDT) {
+      CommandTable->PrdtTable[PrdtIndex].AhciPrdtDbc = RemainedData - 1;
+    } else {
+      CommandTable->PrdtTable[PrdtIndex].AhciPrdtDbc = EFI_AHCI_MAX_DATA_PER_PRDT - 1;
+    }
+
+    Data64.Uint64 = MemAddr;
+    CommandTable->PrdtTable[PrdtIndex].AhciPrdtDba  = Data64.Uint32.Lower32;
+    CommandTable->PrdtTable[PrdtIndex].AhciPrdtDbau = Data64.Uint32.Upper32;
+    RemainedData -= EFI_AHCI_MAX_DATA_PER_PRDT;
+    MemAddr      += EFI_AHCI_MAX_DATA_PER_PRDT;
+  }
+
+  if (PrdtNumber > 0) {
+    CommandTable->PrdtTable[PrdtNumber - 1].AhciPrdtIoc = 1;
+  }
+
+  ZeroMem (CommandList, sizeof (EFI_AHCI_COMMAND_LIST));
+  CommandList->AhciCmdCfl   = EFI_AHCI_FIS_REGISTER_H2D_LENGTH / 4;
+  CommandList->AhciCmdW     = Read ? 0 : 1;
+  CommandList->AhciCmdPrdtl = PrdtNumber;
+  CommandList->AhciCmdPmp   = PortMultiplier;
+
+  Data64.Uint64 = (UINT64)(UINTN) &AhciRegisters->AhciNcqCommandTablePciAddr[CommandSlot];
+  CommandList->AhciCmdCtba  = Data64.Uint32.Lower32;
+  CommandList->AhciCmdCtbau = Data64.Uint32.Upper32;
+
+  if (Instance->NcqActiveSlots == 0) {
+    //
+    // This is the first queued command on the port, so the command list
+    // processing is started here and stays running until the last queued
+    // command completes.
+    //
+    ZeroMem (
+      (VOID *)((UINTN) AhciRegisters->AhciRFis + sizeof (EFI_AHCI_RECEIVED_FIS) * Port),
+      sizeof (EFI_AHCI_RECEIVED_FIS)
+      );
+
+    Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_CMD;
+    AhciAndReg (PciIo, Offset, (UINT32)~(EFI_AHCI_PORT_CMD_DLAE | EFI_AHCI_PORT_CMD_ATAPI));
+
+    Status = AhciStartPort (PciIo, Port, Timeout);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Instance->NcqPort = Port;
+  }
+
+  Instance->NcqActiveSlots |= CmdSlotBit;
+
+  //
+  // PxSACT must be set before PxCI. Writing zero bits to either register has
+  // no effect, so the commands already outstanding are not disturbed.
+  //
+  Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_SACT;
+  AhciWriteReg (PciIo, Offset, CmdSlotBit);
+  Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_CI;
+  AhciWriteReg (PciIo, Offset, CmdSlotBit);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Check whether a queued (FPDMA) command is completed.
+
+  @param  PciIo               The PCI IO protocol instance.
+  @param  Port                The number of port.
+  @param  CommandSlot         The command slot of the command.
+
+  @retval EFI_NOT_READY       The command is still outstanding.
+  @retval EFI_DEVICE_ERROR    The port reported an error.
+  @retval EFI_SUCCESS         The command is completed.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciCheckQueuedCommand (
+  IN EFI_PCI_IO_PROTOCOL          *PciIo,
+  IN UINT8                        Port,
+  IN UINT8                        CommandSlot
+  )
+{
+  UINT32                      Offset;
+  UINT32                      PortIs;
+
+  Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_IS;
+  PortIs = AhciReadReg (PciIo, Offset);
+  if ((PortIs & (EFI_AHCI_PORT_IS_TFES | EFI_AHCI_PORT_IS_HBFS |
+                 EFI_AHCI_PORT_IS_HBDS | EFI_AHCI_PORT_IS_IFS)) != 0) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  //
+  // The device clears the PxSACT bit with a Set Device Bits FIS when the
+  // command with that tag completes.
+  //
+  Offset = EFI_AHCI_PORT_START + Port * EFI_AHCI_PORT_REG_WIDTH + EFI_AHCI_PORT_SACT;
+  if ((AhciReadReg (PciIo, Offset) & (UINT32) (1 << CommandSlot)) != 0) {
+    return EFI_NOT_READY;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Abort all queued (FPDMA) commands in flight and release their data buffer
+  mappings. The tasks of these commands are marked as aborted, so that their
+  clear PxSACT bit is not taken as a completion.
+
+  @param[in]  Instance    A pointer to the ATA_ATAPI_PASS_THRU_INSTANCE instance.
+
+**/
+VOID
+EFIAPI
+AhciAbortQueuedCommands (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE *Instance
+  )
+{
+  EFI_PCI_IO_PROTOCOL         *PciIo;
+  LIST_ENTRY                  *Entry;
+  ATA_NONBLOCK_TASK           *Task;
+
+  if (Instance->NcqActiveSlots == 0) {
+    return;
+  }
+
+  PciIo = Instance->PciIo;
+
+  //
+  // Clearing PxCMD.ST also clears PxSACT and PxCI.
+  //
+  AhciStopCommand (PciIo, (UINT8) Instance->NcqPort, ATA_ATAPI_TIMEOUT);
+  AhciDisableFisReceive (PciIo, (UINT8) Instance->NcqPort, ATA_ATAPI_TIMEOUT);
+
+  for (Entry = GetFirstNode (&Instance->NonBlockingTaskList);
+       !IsNull (&Instance->NonBlockingTaskList, Entry);
+       Entry = GetNextNode (&Instance->NonBlockingTaskList, Entry)) {
+    Task = ATA_NON_BLOCK_TASK_FROM_ENTRY (Entry);
+    if (Task->IsStart &&
+        (Task->Packet->Protocol == EFI_ATA_PASS_THRU_PROTOCOL_FPDMA) &&
+        !Task->IsAborted) {
+      if (Task->Map != NULL) {
+        PciIo->Unmap (PciIo, Task->Map);
+        Task->Map = NULL;
+      }
+      Task->IsAborted = TRUE;
+    }
+  }
+
+  Instance->NcqActiveSlots = 0;
+}
+
+/**
+  Start a queued (FPDMA) data transfer on specific port.
+
+  In non-blocking mode the command is issued in a free command slot and the
+  function returns EFI_NOT_READY, so that several queued commands may be
+  outstanding on the port at the same time.
+
+  @param[in]       Instance            The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param[in]       AhciRegisters       The pointer to the EFI_AHCI_REGISTERS.
+  @param[in]       Port                The number of port.
+  @param[in]       PortMultiplier      The number of port multiplier.
+  @param[in]       Read                The transfer direction.
+  @param[in]       AtaCommandBlock     The EFI_ATA_COMMAND_BLOCK data.
+  @param[in, out]  AtaStatusBlock      The EFI_ATA_STATUS_BLOCK data.
+  @param[in, out]  MemoryAddr          The pointer to the data buffer.
+  @param[in]       DataCount           The data count to be transferred.
+  @param[in]       Timeout             The timeout value of data transfer, uses 100ns as a unit.
+  @param[in]       Task                Optional. Pointer to the ATA_NONBLOCK_TASK
+                                       used by non-blocking mode.
+
+  @retval EFI_NOT_READY       The command is issued or waits for a free slot.
+  @retval EFI_UNSUPPORTED     The HBA does not support native command queuing.
+  @retval EFI_BAD_BUFFER_SIZE The data buffer can not be described by the PRD table.
+  @retval EFI_DEVICE_ERROR    The DMA data transfer abort with error occurs.
+  @retval EFI_TIMEOUT         The operation is time out.
+  @retval EFI_SUCCESS         The DMA data transfer executes successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciQueuedDmaTransfer (
+  IN     ATA_ATAPI_PASS_THRU_INSTANCE *Instance,
+  IN     EFI_AHCI_REGISTERS           *AhciRegisters,
+  IN     UINT8                        Port,
+  IN     UINT8                        PortMultiplier,
+  IN     BOOLEAN                      Read,
+  IN     EFI_ATA_COMMAND_BLOCK        *AtaCommandBlock,
+  IN OUT EFI_ATA_STATUS_BLOCK         *AtaStatusBlock,
+  IN OUT VOID                         *MemoryAddr,
+  IN     UINT32                       DataCount,
+  IN     UINT64                       Timeout,
+  IN     ATA_NONBLOCK_TASK            *Task
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_PCI_IO_PROTOCOL           *PciIo;
+  EFI_PHYSICAL_ADDRESS          PhyAddr;
+  VOID                          *Map;
+  UINTN                         MapLength;
+  EFI_PCI_IO_PROTOCOL_OPERATION Flag;
+  INTN                          FreeSlot;
+  UINT8                         CommandSlot;
+  UINT64                        Delay;
+  BOOLEAN                       InfiniteWait;
+  EFI_TPL                       OldTpl;
+  UINT8                         LogData[512];
+
+  PciIo = Instance->PciIo;
+
+  if (PciIo == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (AhciRegisters->AhciNcqCommandTable == NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (DivU64x32 ((UINT64)DataCount + EFI_AHCI_MAX_DATA_PER_PRDT - 1, EFI_AHCI_MAX_DATA_PER_PRDT) > EFI_AHCI_NCQ_MAX_PRDT_NUMBER) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  //
+  // Before starting the Blocking BlockIO operation, push to finish all non-blocking
+  // BlockIO tasks.
+  // Delay 100us to simulate the blocking time out checking.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  while ((Task == NULL) && (!IsListEmpty (&Instance->NonBlockingTaskList))) {
+    AsyncNonBlockingTransferRoutine (NULL, Instance);
+    //
+    // Stall for 100us.
+    //
+    MicroSecondDelay (100);
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  Map         = NULL;
+  CommandSlot = 0;
+  if ((Task == NULL) || (!Task->IsStart)) {
+    if (Task != NULL) {
+      //
+      // Queued commands are only outstanding on one port at a time, and each
+      // one takes a free command slot below the queue depth of the device.
+      //
+      if ((Instance->NcqActiveSlots != 0) && (Instance->NcqPort != Port)) {
+        return EFI_NOT_READY;
+      }
+      FreeSlot = LowBitSet32 (~Instance->NcqActiveSlots);
+      if ((FreeSlot < 0) || (FreeSlot >= MIN (Task->QueueDepth, AhciRegisters->NcqSlotNumber))) {
+        return EFI_NOT_READY;
+      }
+      CommandSlot = (UINT8) FreeSlot;
+    }
+
+    if (Read) {
+      Flag = EfiPciIoOperationBusMasterWrite;
+    } else {
+      Flag = EfiPciIoOperationBusMasterRead;
+    }
+
+    MapLength = DataCount;
+    Status = PciIo->Map (
+                      PciIo,
+                      Flag,
+                      MemoryAddr,
+                      &MapLength,
+                      &PhyAddr,
+                      &Map
+                      );
+
+    if (EFI_ERROR (Status) || (DataCount != MapLength)) {
+      if (!EFI_ERROR (Status)) {
+        PciIo->Unmap (PciIo, Map);
+      }
+      return EFI_BAD_BUFFER_SIZE;
+    }
+
+    Status = AhciIssueQueuedCommand (
+               Instance,
+               AhciRegisters,
+               Port,
+               PortMultiplier,
+               Read,
+               AtaCommandBlock,
+               CommandSlot,
+               PhyAddr,
+               DataCount,
+               Timeout
+               );
+    if (EFI_ERROR (Status)) {
+      PciIo->Unmap (PciIo, Map);
+      return Status;
+    }
+
+    if (Task != NULL) {
+      //
+      // Mark the Task to indicate that it has been started.
+      //
+      Task->IsStart     = TRUE;
+      Task->Map         = Map;
+      Task->CommandSlot = CommandSlot;
+      return EFI_NOT_READY;
+    }
+  }
+
+  //
+  // Wait for command complete
+  //
+  if (Task != NULL) {
+    //
+    // For Non-blocking
+    //
+    if (Task->IsAborted) {
+      //
+      // The command was ended with the other queued commands, and its data
+      // buffer mapping is already released.
+      //
+      return EFI_ABORTED;
+    }
+
+    Map         = Task->Map;
+    CommandSlot = Task->CommandSlot;
+    Task->RetryTimes--;
+    Status = AhciCheckQueuedCommand (PciIo, Port, CommandSlot);
+    if (Status == EFI_NOT_READY) {
+      if (Task->InfiniteWait || (Task->RetryTimes != 0)) {
+        return EFI_NOT_READY;
+      }
+      Status = EFI_TIMEOUT;
+    }
+  } else {
+    InfiniteWait = (BOOLEAN) (Timeout == 0);
+    Delay        = DivU64x32 (Timeout, 1000) + 1;
+    do {
+      Status = AhciCheckQueuedCommand (PciIo, Port, CommandSlot);
+      if (Status != EFI_NOT_READY) {
+        break;
+      }
+
+      //
+      // Stall for 100 microseconds.
+      //
+      MicroSecondDelay (100);
+
+      Delay--;
+    } while (InfiniteWait || (Delay > 0));
+
+    if (Status == EFI_NOT_READY) {
+      Status = EFI_TIMEOUT;
+    }
+  }
+
+  AhciDumpPortStatus (PciIo, AhciRegisters, Port, AtaStatusBlock);
+
+  if (EFI_ERROR (Status)) {
+    //
+    // An error or a timeout ends every queued command outstanding on the port,
+    // the caller fails all pending tasks.
+    //
+    AhciAbortQueuedCommands (Instance);
+    if (Task == NULL) {
+      PciIo->Unmap (PciIo, Map);
+    }
+
+    if (Status == EFI_DEVICE_ERROR) {
+      //
+      // The device does not accept any queued command after an error until
+      // the NCQ Command Error log is read.
+      //
+      AhciReadLogExt (PciIo, AhciRegisters, Port, PortMultiplier, LogData, 0x10, 0x00);
+    }
+    return Status;
+  }
+
+  PciIo->Unmap (PciIo, Map);
+  if (Task != NULL) {
+    Task->Map = NULL;
+  }
+
+  Instance->NcqActiveSlots &= ~((UINT32) (1 << CommandSlot));
+  if (Instance->NcqActiveSlots == 0) {
+    AhciStopCommand (
+      PciIo,
+      Port,
+      Timeout
+      );
+
+    AhciDisableFisReceive (
+      PciIo,
+      Port,
+      Timeout
+      );
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Enable DEVSLP of the disk if supported.
 
@@ -199,6 +199,7 @@ AtaPassThruPassThruExecute (
   EFI_ATA_PASS_THRU_CMD_PROTOCOL  Protocol;
   EFI_ATA_HC_WORK_MODE            Mode;
   EFI_STATUS                      Status;
+  EFI_TPL                         OldTpl;
 
   Protocol = Packet->Protocol;
 
@@ -290,6 +291,30 @@ AtaPassThruPassThruExecute (
         //
         PortMultiplierPort = 0;
       }
+
+      if ((Task == NULL) &&
+          ((Protocol == EFI_ATA_PASS_THRU_PROTOCOL_ATA_NON_DATA) ||
+           (Protocol == EFI_ATA_PASS_THRU_PROTOCOL_PIO_DATA_IN) ||
+           (Protocol == EFI_ATA_PASS_THRU_PROTOCOL_PIO_DATA_OUT))) {
+        //
+        // AhciNonDataTransfer() and AhciPioTransfer() use command slot 0 and
+        // stop the port when done, which would end the queued commands still
+        // outstanding. A non-queued command is not allowed while queued ones
+        // are active either. So, as AhciDmaTransfer() does, push to finish all
+        // non-blocking tasks before starting the blocking one.
+        // Delay 100us to simulate the blocking time out checking.
+        //
+        OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+        while (!IsListEmpty (&Instance->NonBlockingTaskList)) {
+          AsyncNonBlockingTransferRoutine (NULL, Instance);
+          //
+          // Stall for 100us.
+          //
+          MicroSecondDelay (100);
+        }
+        gBS->RestoreTPL (OldTpl);
+      }
+
       switch (Protocol) {
         case EFI_ATA_PASS_THRU_PROTOCOL_ATA_NON_DATA:
           Status = AhciNonDataTransfer (
@@ -373,6 +398,37 @@ AtaPassThruPassThruExecute (
                      Task
                      );
           break;
+        case EFI_ATA_PASS_THRU_PROTOCOL_FPDMA:
+          if (Packet->InTransferLength != 0) {
+            Status = AhciQueuedDmaTransfer (
+                       Instance,
+                       &Instance->AhciRegisters,
+                       (UINT8)Port,
+                       (UINT8)PortMultiplierPort,
+                       TRUE,
+                       Packet->Acb,
+                       Packet->Asb,
+                       Packet->InDataBuffer,
+                       Packet->InTransferLength,
+                       Packet->Timeout,
+                       Task
+                       );
+          } else {
+            Status = AhciQueuedDmaTransfer (
+                       Instance,
+                       &Instance->AhciRegisters,
+                       (UINT8)Port,
+                       (UINT8)PortMultiplierPort,
+                       FALSE,
+                       Packet->Acb,
+                       Packet->Asb,
+                       Packet->OutDataBuffer,
+                       Packet->OutTransferLength,
+                       Packet->Timeout,
+                       Task
+                       );
+          }
+          break;
         default :
           return EFI_UNSUPPORTED;
       }
@@ -402,6 +458,7 @@ AsyncNonBlockingTransferRoutine (
   )
 {
   LIST_ENTRY                   *Entry;
+  LIST_ENTRY                   *NextEntry;
   LIST_ENTRY                   *EntryHeader;
   ATA_NONBLOCK_TASK            *Task;
   EFI_STATUS                   Status;
@@ -412,13 +469,20 @@ AsyncNonBlockingTransferRoutine (
   //
   // Get the Taks from the Taks List and execute it, until there is
   // no task in the list or the device is busy with task (EFI_NOT_READY).
+  // Queued (FPDMA) tasks do not keep the device busy, so the tasks behind
+  // them are also executed until a task which is not queued is reached.
   //
-  while (TRUE) {
-    if (!IsListEmpty (EntryHeader)) {
-      Entry = GetFirstNode (EntryHeader);
-      Task  = ATA_NON_BLOCK_TASK_FROM_ENTRY (Entry);
-    } else {
-      return;
+  Entry = GetFirstNode (EntryHeader);
+  while (!IsNull (EntryHeader, Entry)) {
+    Task      = ATA_NON_BLOCK_TASK_FROM_ENTRY (Entry);
+    NextEntry = GetNextNode (EntryHeader, Entry);
+
+    //
+    // A task which is not queued waits until all queued commands completed.
+    //
+    if ((Task->Packet->Protocol != EFI_ATA_PASS_THRU_PROTOCOL_FPDMA) &&
+        (Instance->NcqActiveSlots != 0)) {
+      break;
     }
 
     Status = AtaPassThruPassThruExecute (
@@ -443,12 +507,16 @@ AsyncNonBlockingTransferRoutine (
     // is not finished yet. Otherwise the operation is successful.
     //
     if (Status == EFI_NOT_READY) {
-      break;
+      if (Task->Packet->Protocol != EFI_ATA_PASS_THRU_PROTOCOL_FPDMA) {
+        break;
+      }
     } else {
       RemoveEntryList (&Task->Link);
       gBS->SignalEvent (Task->Event);
       FreePool (Task);
     }
+
+    Entry = NextEntry;
   }
 }
 
@@ -947,6 +1015,17 @@ AtaAtapiPassThruStop (
   //
   if (Instance->Mode == EfiAtaAhciMode) {
     AhciRegisters = &Instance->AhciRegisters;
+    if (AhciRegisters->AhciNcqCommandTable != NULL) {
+      PciIo->Unmap (
+               PciIo,
+               AhciRegisters->MapNcqCommandTable
+               );
+      PciIo->FreeBuffer (
+               PciIo,
+               EFI_SIZE_TO_PAGES ((UINTN) AhciRegisters->MaxNcqCommandTableSize),
+               AhciRegisters->AhciNcqCommandTable
+               );
+    }
     PciIo->Unmap (
              PciIo,
              AhciRegisters->MapCommandTable
@@ -1145,6 +1224,13 @@ DestroyAsynTaskList (
   EFI_TPL              OldTpl;
 
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  if (Instance->Mode == EfiAtaAhciMode) {
+    //
+    // Queued commands still reference the task buffers, abort them first.
+    //
+    AhciAbortQueuedCommands (Instance);
+  }
+
   if (!IsListEmpty (&Instance->NonBlockingTaskList)) {
     //
     // Free the Subtask list.
@@ -1284,6 +1370,7 @@ AtaPassThruPassThru (
   ATA_NONBLOCK_TASK               *Task;
   EFI_TPL                         OldTpl;
   UINT32                          BlockSize;
+  BOOLEAN                         IsHarddisk;
 
   Instance = ATA_PASS_THRU_PRIVATE_DATA_FROM_THIS (This);
 
@@ -1299,13 +1386,15 @@ AtaPassThruPassThru (
     return EFI_INVALID_PARAMETER;
   }
 
-  Node = SearchDeviceInfoList (Instance, Port, PortMultiplierPort, EfiIdeHarddisk);
+  Node       = SearchDeviceInfoList (Instance, Port, PortMultiplierPort, EfiIdeHarddisk);
+  IsHarddisk = TRUE;
 
   if (Node == NULL) {
     Node = SearchDeviceInfoList(Instance, Port, PortMultiplierPort, EfiIdeCdrom);
     if (Node == NULL) {
       return EFI_INVALID_PARAMETER;
     }
+    IsHarddisk = FALSE;
   }
 
   //
@@ -1337,6 +1426,21 @@ AtaPassThruPassThru (
     }
   }
 
+  //
+  // Queued (FPDMA) commands are only supported on an AHCI controller with
+  // native command queuing, and on a hard disk reporting NCQ support in
+  // word 76 of the identify data.
+  //
+  if (Packet->Protocol == EFI_ATA_PASS_THRU_PROTOCOL_FPDMA) {
+    if ((Instance->Mode != EfiAtaAhciMode) ||
+        (Instance->AhciRegisters.AhciNcqCommandTable == NULL) ||
+        !IsHarddisk ||
+        (IdentifyData->AtaData.serial_ata_capabilities == 0xFFFF) ||
+        ((IdentifyData->AtaData.serial_ata_capabilities & BIT8) == 0)) {
+      return EFI_UNSUPPORTED;
+    }
+  }
+
   //
   // convert the transfer length from sector count to byte.
   //
@@ -1378,6 +1482,12 @@ AtaPassThruPassThru (
     Task->Packet         = Packet;
     Task->Event          = Event;
     Task->IsStart        = FALSE;
+    if (Packet->Protocol == EFI_ATA_PASS_THRU_PROTOCOL_FPDMA) {
+      //
+      // Word 75 bits 4:0 of the identify data is the maximum queue depth - 1.
+      //
+      Task->QueueDepth   = (UINT8) ((IdentifyData->AtaData.queue_depth & 0x1F) + 1);
+    }
     Task->RetryTimes     = DivU64x32(Packet->Timeout, 1000) + 1;
     if (Packet->Timeout == 0) {
       Task->InfiniteWait = TRUE;
@@ -124,6 +124,12 @@ typedef struct {
   //
   EFI_EVENT                         TimerEvent;
   LIST_ENTRY                        NonBlockingTaskList;
+  //
+  // Queued (FPDMA) commands in flight. All ports share one command list, so
+  // queued commands are only outstanding on one port at a time.
+  //
+  UINT16                            NcqPort;
+  UINT32                            NcqActiveSlots;
 } ATA_ATAPI_PASS_THRU_INSTANCE;
 
 //
@@ -144,6 +150,9 @@ struct _ATA_NONBLOCK_TASK {
   VOID                              *TableMap;       // Pointer to PRD table map.
   EFI_ATA_DMA_PRD                   *MapBaseAddress; //  Pointer to range Base address for Map.
   UINTN                             PageCount;       //  The page numbers used by PCIO freebuffer.
+  UINT8                             QueueDepth;      //  The queue depth usable by FPDMA command.
+  UINT8                             CommandSlot;     //  The command slot used by FPDMA command.
+  BOOLEAN                           IsAborted;       //  The FPDMA command was ended by AhciAbortQueuedCommands().
 };
 
 //
@@ -1155,6 +1164,63 @@ AhciDmaTransfer (
   IN     ATA_NONBLOCK_TASK            *Task
   );
 
+/**
+  Start a queued (FPDMA) data transfer on specific port.
+
+  In non-blocking mode the command is issued in a free command slot and the
+  function returns EFI_NOT_READY, so that several queued commands may be
+  outstanding on the port at the same time.
+
+  @param[in]       Instance            The ATA_ATAPI_PASS_THRU_INSTANCE protocol instance.
+  @param[in]       AhciRegisters       The pointer to the EFI_AHCI_REGISTERS.
+  @param[in]       Port                The number of port.
+  @param[in]       PortMultiplier      The number of port multiplier.
+  @param[in]       Read                The transfer direction.
+  @param[in]       AtaCommandBlock     The EFI_ATA_COMMAND_BLOCK data.
+  @param[in, out]  AtaStatusBlock      The EFI_ATA_STATUS_BLOCK data.
+  @param[in, out]  MemoryAddr          The pointer to the data buffer.
+  @param[in]       DataCount           The data count to be transferred.
+  @param[in]       Timeout             The timeout value of data transfer, uses 100ns as a unit.
+  @param[in]       Task                Optional. Pointer to the ATA_NONBLOCK_TASK
+                                       used by non-blocking mode.
+
+  @retval EFI_NOT_READY       The command is issued or waits for a free slot.
+  @retval EFI_UNSUPPORTED     The HBA does not support native command queuing.
+  @retval EFI_BAD_BUFFER_SIZE The data buffer can not be described by the PRD table.
+  @retval EFI_DEVICE_ERROR    The DMA data transfer abort with error occurs.
+  @retval EFI_TIMEOUT         The operation is time out.
+  @retval EFI_SUCCESS         The DMA data transfer executes successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AhciQueuedDmaTransfer (
+  IN     ATA_ATAPI_PASS_THRU_INSTANCE *Instance,
+  IN     EFI_AHCI_REGISTERS           *AhciRegisters,
+  IN     UINT8                        Port,
+  IN     UINT8                        PortMultiplier,
+  IN     BOOLEAN                      Read,
+  IN     EFI_ATA_COMMAND_BLOCK        *AtaCommandBlock,
+  IN OUT EFI_ATA_STATUS_BLOCK         *AtaStatusBlock,
+  IN OUT VOID                         *MemoryAddr,
+  IN     UINT32                       DataCount,
+  IN     UINT64                       Timeout,
+  IN     ATA_NONBLOCK_TASK            *Task
+  );
+
+/**
+  Abort all queued (FPDMA) commands in flight and release their data buffer
+  mappings.
+
+  @param[in]  Instance    A pointer to the ATA_ATAPI_PASS_THRU_INSTANCE instance.
+
+**/
+VOID
+EFIAPI
+AhciAbortQueuedCommands (
+  IN ATA_ATAPI_PASS_THRU_INSTANCE *Instance
+  );
+
 /**
   Start a PIO data transfer on specific port.
 
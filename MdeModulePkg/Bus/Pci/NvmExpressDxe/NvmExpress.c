@@ -516,43 +516,27 @@ UnregisterNvmeNamespace (
 }
 
 /**
-  Call back function when the timer event is signaled.
+  Submit the queued asynchronous subtasks to the asynchronous I/O submission
+  queue until the queue is full.
 
-  @param[in]  Event     The Event this notify function registered to.
-  @param[in]  Context   Pointer to the context data registered to the
-                        Event.
+  The caller must be at TPL_NOTIFY.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
 
 **/
 VOID
-EFIAPI
-ProcessAsyncTaskList (
-  IN EFI_EVENT                    Event,
-  IN VOID*                        Context
+NvmeSubmitAsyncSubtasks (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private
   )
 {
-  NVME_CONTROLLER_PRIVATE_DATA         *Private;
-  EFI_PCI_IO_PROTOCOL                  *PciIo;
-  NVME_CQ                              *Cq;
-  UINT16                               QueueId;
-  UINT32                               Data;
   LIST_ENTRY                           *Link;
   LIST_ENTRY                           *NextLink;
-  NVME_PASS_THRU_ASYNC_REQ             *AsyncRequest;
   NVME_BLKIO2_SUBTASK                  *Subtask;
   NVME_BLKIO2_REQUEST                  *BlkIo2Request;
   EFI_BLOCK_IO2_TOKEN                  *Token;
-  BOOLEAN                              HasNewItem;
   EFI_STATUS                           Status;
 
-  Private    = (NVME_CONTROLLER_PRIVATE_DATA*)Context;
-  QueueId    = 2;
-  Cq         = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
-  HasNewItem = FALSE;
-  PciIo      = Private->PciIo;
-
-  //
-  // Submit asynchronous subtasks to the NVMe Submission Queue
-  //
   for (Link = GetFirstNode (&Private->UnsubmittedSubtasks);
        !IsNull (&Private->UnsubmittedSubtasks, Link);
        Link = NextLink) {
@@ -620,6 +604,43 @@ ProcessAsyncTaskList (
       }
     }
   }
+}
+
+/**
+  Call back function when the timer event is signaled.
+
+  @param[in]  Event     The Event this notify function registered to.
+  @param[in]  Context   Pointer to the context data registered to the
+                        Event.
+
+**/
+VOID
+EFIAPI
+ProcessAsyncTaskList (
+  IN EFI_EVENT                    Event,
+  IN VOID*                        Context
+  )
+{
+  NVME_CONTROLLER_PRIVATE_DATA         *Private;
+  EFI_PCI_IO_PROTOCOL                  *PciIo;
+  NVME_CQ                              *Cq;
+  UINT16                               QueueId;
+  UINT32                               Data;
+  LIST_ENTRY                           *Link;
+  LIST_ENTRY                           *NextLink;
+  NVME_PASS_THRU_ASYNC_REQ             *AsyncRequest;
+  BOOLEAN                              HasNewItem;
+
+  Private    = (NVME_CONTROLLER_PRIVATE_DATA*)Context;
+  QueueId    = 2;
+  Cq         = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
+  HasNewItem = FALSE;
+  PciIo      = Private->PciIo;
+
+  //
+  // Submit asynchronous subtasks to the NVMe Submission Queue
+  //
+  NvmeSubmitAsyncSubtasks (Private);
 
   while (Cq->Pt != Private->Pt[QueueId]) {
     ASSERT (Cq->Sqid == QueueId);
@@ -658,11 +679,11 @@ ProcessAsyncTaskList (
           PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
         }
         if (AsyncRequest->PrpListHost != NULL) {
-          PciIo->FreeBuffer (
-                   PciIo,
-                   AsyncRequest->PrpListNo,
-                   AsyncRequest->PrpListHost
-                   );
+          NvmeFreePrpList (
+            Private,
+            AsyncRequest->PrpListHost,
+            AsyncRequest->PrpListNo
+            );
         }
 
         RemoveEntryList (Link);
@@ -696,6 +717,12 @@ ProcessAsyncTaskList (
                  1,
                  &Data
                  );
+
+    //
+    // The completions freed submission queue entries, refill them now
+    // instead of waiting for the next timer tick.
+    //
+    NvmeSubmitAsyncSubtasks (Private);
   }
 }
 
@@ -1009,6 +1036,8 @@ NvmExpressDriverBindingStart (
     InitializeListHead (&Private->AsyncPassThruQueue);
     InitializeListHead (&Private->UnsubmittedSubtasks);
 
+    NvmeCreatePrpListPool (Private);
+
     Status = NvmeControllerInit (Private);
     if (EFI_ERROR(Status)) {
       goto Exit;
@@ -1106,6 +1135,10 @@ Exit:
     FreePool (Private->ControllerData);
   }
 
+  if ((Private != NULL) && (Private->PrpListPool != NULL)) {
+    NvmeFreePrpListPool (Private);
+  }
+
   if (Private != NULL) {
     if (Private->TimerEvent != NULL) {
       gBS->CloseEvent (Private->TimerEvent);
@@ -1225,6 +1258,8 @@ NvmExpressDriverBindingStop (
         Private->PciIo->FreeBuffer (Private->PciIo, 6, Private->Buffer);
       }
 
+      NvmeFreePrpListPool (Private);
+
       FreePool (Private->ControllerData);
       FreePool (Private);
     }
@@ -80,6 +80,12 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gNvmExpressDriverSupportedEfiV
 
 #define NVME_MAX_QUEUES                           3     // Number of queues supported by the driver
 
+//
+// Number of pre-mapped PRP list pages kept per controller. One page is the
+// PRP list of a command transferring up to 2MB.
+//
+#define NVME_PRP_LIST_POOL_PAGES                  16
+
 #define NVME_CONTROLLER_ID                        0
 
 //
@@ -162,6 +168,15 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
 
   VOID                                *Mapping;
 
+  //
+  // Pool of pre-mapped single page PRP lists. Bit N of PrpListPoolInUse is
+  // set when the Nth page is used by an outstanding command.
+  //
+  UINT8                               *PrpListPool;
+  EFI_PHYSICAL_ADDRESS                PrpListPoolPciAddr;
+  VOID                                *PrpListPoolMapping;
+  UINT32                              PrpListPoolInUse;
+
   //
   // For Non-blocking operations.
   //
@@ -727,6 +742,64 @@ NvmeDumpStatus (
   IN NVME_CQ             *Cq
   );
 
+/**
+  Allocate the pool of pre-mapped PRP lists of an NVM Express controller.
+
+  The pool is optional. If it cannot be allocated, the PRP lists are
+  allocated per command.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeCreatePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private
+  );
+
+/**
+  Free the pool of pre-mapped PRP lists of an NVM Express controller.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeFreePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private
+  );
+
+/**
+  Free the PRP lists of a command.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpListHost    The host base address of the PRP lists.
+  @param[in] PrpListNo      The number of PRP lists.
+
+**/
+VOID
+NvmeFreePrpList (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private,
+  IN VOID                             *PrpListHost,
+  IN UINTN                            PrpListNo
+  );
+
+/**
+  Submit the queued asynchronous subtasks to the asynchronous I/O submission
+  queue until the queue is full.
+
+  The caller must be at TPL_NOTIFY.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeSubmitAsyncSubtasks (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private
+  );
+
 /**
   Register the shutdown notification through the ResetNotification protocol.
 
@@ -802,6 +802,14 @@ NvmeAsyncRead (
     }
   }
 
+  //
+  // Hand the queued subtasks to the controller now rather than on the next
+  // tick of the asynchronous I/O timer.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  NvmeSubmitAsyncSubtasks (Private);
+  gBS->RestoreTPL (OldTpl);
+
   DEBUG ((DEBUG_BLKIO, "%a: Lba = 0x%08Lx, Original = 0x%08Lx, "
     "Remaining = 0x%08Lx, BlockSize = 0x%x, Status = %r\n", __FUNCTION__, Lba,
     (UINT64)OrginalBlocks, (UINT64)Blocks, BlockSize, Status));
@@ -922,6 +930,14 @@ NvmeAsyncWrite (
     }
   }
 
+  //
+  // Hand the queued subtasks to the controller now rather than on the next
+  // tick of the asynchronous I/O timer.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  NvmeSubmitAsyncSubtasks (Private);
+  gBS->RestoreTPL (OldTpl);
+
   DEBUG ((DEBUG_BLKIO, "%a: Lba = 0x%08Lx, Original = 0x%08Lx, "
     "Remaining = 0x%08Lx, BlockSize = 0x%x, Status = %r\n", __FUNCTION__, Lba,
     (UINT64)OrginalBlocks, (UINT64)Blocks, BlockSize, Status));
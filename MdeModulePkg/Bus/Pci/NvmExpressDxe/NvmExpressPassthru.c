@@ -315,6 +315,172 @@ EXIT:
   return NULL;
 }
 
+/**
+  Allocate the pool of pre-mapped PRP lists of an NVM Express controller.
+
+  The pool is optional. If it cannot be allocated, the PRP lists are
+  allocated per command.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeCreatePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private
+  )
+{
+  EFI_PCI_IO_PROTOCOL         *PciIo;
+  VOID                        *PoolHost;
+  VOID                        *Mapping;
+  EFI_PHYSICAL_ADDRESS        PoolPhyAddr;
+  UINTN                       Bytes;
+  EFI_STATUS                  Status;
+
+  PciIo  = Private->PciIo;
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    NVME_PRP_LIST_POOL_PAGES,
+                    &PoolHost,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "NvmeCreatePrpListPool: allocate PrpList pool failure - %r\n", Status));
+    return;
+  }
+
+  Bytes  = EFI_PAGES_TO_SIZE (NVME_PRP_LIST_POOL_PAGES);
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    PoolHost,
+                    &Bytes,
+                    &PoolPhyAddr,
+                    &Mapping
+                    );
+  if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (NVME_PRP_LIST_POOL_PAGES))) {
+    DEBUG ((DEBUG_WARN, "NvmeCreatePrpListPool: map PrpList pool failure - %r\n", Status));
+    if (!EFI_ERROR (Status)) {
+      PciIo->Unmap (PciIo, Mapping);
+    }
+    PciIo->FreeBuffer (PciIo, NVME_PRP_LIST_POOL_PAGES, PoolHost);
+    return;
+  }
+
+  Private->PrpListPool        = PoolHost;
+  Private->PrpListPoolPciAddr = PoolPhyAddr;
+  Private->PrpListPoolMapping = Mapping;
+  Private->PrpListPoolInUse   = 0;
+}
+
+/**
+  Free the pool of pre-mapped PRP lists of an NVM Express controller.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeFreePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private
+  )
+{
+  if (Private->PrpListPool == NULL) {
+    return;
+  }
+
+  Private->PciIo->Unmap (Private->PciIo, Private->PrpListPoolMapping);
+  Private->PciIo->FreeBuffer (Private->PciIo, NVME_PRP_LIST_POOL_PAGES, Private->PrpListPool);
+  Private->PrpListPool        = NULL;
+  Private->PrpListPoolMapping = NULL;
+}
+
+/**
+  Build a single page PRP list in a free page of the PRP list pool.
+
+  @param[in]  Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                             data structure.
+  @param[in]  PhysicalAddr   The physical base address of data buffer.
+  @param[in]  Pages          The number of pages to be transfered.
+  @param[out] PrpListHost    The host base address of the PRP list.
+
+  @retval The device address of the PRP list, or NULL if the pool has no free
+          page or the transfer needs more than one PRP list.
+
+**/
+VOID*
+NvmeAllocatePrpListFromPool (
+  IN     NVME_CONTROLLER_PRIVATE_DATA *Private,
+  IN     EFI_PHYSICAL_ADDRESS         PhysicalAddr,
+  IN     UINTN                        Pages,
+     OUT VOID                         **PrpListHost
+  )
+{
+  UINTN                       Index;
+  UINTN                       PrpEntryIndex;
+  UINT64                      *PrpList;
+  EFI_TPL                     OldTpl;
+
+  if ((Private->PrpListPool == NULL) || (Pages > EFI_PAGE_SIZE / sizeof (UINT64))) {
+    return NULL;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  for (Index = 0; Index < NVME_PRP_LIST_POOL_PAGES; Index++) {
+    if ((Private->PrpListPoolInUse & (1U << Index)) == 0) {
+      Private->PrpListPoolInUse |= (1U << Index);
+      break;
+    }
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  if (Index == NVME_PRP_LIST_POOL_PAGES) {
+    return NULL;
+  }
+
+  PrpList = (UINT64 *)(Private->PrpListPool + EFI_PAGES_TO_SIZE (Index));
+  for (PrpEntryIndex = 0; PrpEntryIndex < Pages; ++PrpEntryIndex) {
+    PrpList[PrpEntryIndex] = PhysicalAddr;
+    PhysicalAddr += EFI_PAGE_SIZE;
+  }
+
+  *PrpListHost = PrpList;
+  return (VOID*)(UINTN)(Private->PrpListPoolPciAddr + EFI_PAGES_TO_SIZE (Index));
+}
+
+/**
+  Free the PRP lists of a command.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpListHost    The host base address of the PRP lists.
+  @param[in] PrpListNo      The number of PRP lists.
+
+**/
+VOID
+NvmeFreePrpList (
+  IN NVME_CONTROLLER_PRIVATE_DATA     *Private,
+  IN VOID                             *PrpListHost,
+  IN UINTN                            PrpListNo
+  )
+{
+  UINTN                       Index;
+  EFI_TPL                     OldTpl;
+
+  if ((Private->PrpListPool != NULL) &&
+      ((UINT8 *)PrpListHost >= Private->PrpListPool) &&
+      ((UINT8 *)PrpListHost < Private->PrpListPool + EFI_PAGES_TO_SIZE (NVME_PRP_LIST_POOL_PAGES))) {
+    Index  = (UINTN)((UINT8 *)PrpListHost - Private->PrpListPool) >> EFI_PAGE_SHIFT;
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    Private->PrpListPoolInUse &= ~(1U << Index);
+    gBS->RestoreTPL (OldTpl);
+  } else {
+    Private->PciIo->FreeBuffer (Private->PciIo, PrpListNo, PrpListHost);
+  }
+}
+
 
 /**
   Aborts the asynchronous PassThru requests.
@@ -385,11 +551,11 @@ AbortAsyncPassThruTasks (
       PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
     }
     if (AsyncRequest->PrpListHost != NULL) {
-      PciIo->FreeBuffer (
-               PciIo,
-               AsyncRequest->PrpListNo,
-               AsyncRequest->PrpListHost
-               );
+      NvmeFreePrpList (
+        Private,
+        AsyncRequest->PrpListHost,
+        AsyncRequest->PrpListNo
+        );
     }
 
     RemoveEntryList (Link);
@@ -663,10 +829,14 @@ NvmExpressPassThru (
 
   if ((Offset + Bytes) > (EFI_PAGE_SIZE * 2)) {
     //
-    // Create PrpList for remaining data buffer.
+    // Create PrpList for remaining data buffer. Take it from the pre-mapped
+    // pool when possible to avoid allocating and mapping it per command.
     //
     PhyAddr = (Sq->Prp[0] + EFI_PAGE_SIZE) & ~(EFI_PAGE_SIZE - 1);
-    Prp = NvmeCreatePrpList (PciIo, PhyAddr, EFI_SIZE_TO_PAGES(Offset + Bytes) - 1, &PrpListHost, &PrpListNo, &MapPrpList);
+    Prp = NvmeAllocatePrpListFromPool (Private, PhyAddr, EFI_SIZE_TO_PAGES(Offset + Bytes) - 1, &PrpListHost);
+    if (Prp == NULL) {
+      Prp = NvmeCreatePrpList (PciIo, PhyAddr, EFI_SIZE_TO_PAGES(Offset + Bytes) - 1, &PrpListHost, &PrpListNo, &MapPrpList);
+    }
     if (Prp == NULL) {
       Status = EFI_OUT_OF_RESOURCES;
       goto EXIT;
@@ -890,7 +1060,7 @@ EXIT:
   }
 
   if (Prp != NULL) {
-    PciIo->FreeBuffer (PciIo, PrpListNo, PrpListHost);
+    NvmeFreePrpList (Private, PrpListHost, PrpListNo);
   }
 
   if (TimerEvent != NULL) {
@@ -113,6 +113,13 @@ PciPciDeviceInfoCollector (
 
   for (Device = 0; Device <= PCI_MAX_DEVICE; Device++) {
 
+    //
+    // Skip the device found absent when the bus numbers were assigned
+    //
+    if (PciIsDeviceAbsent (StartBusNumber, Device)) {
+      continue;
+    }
+
     for (Func = 0; Func <= PCI_MAX_FUNC; Func++) {
 
       //
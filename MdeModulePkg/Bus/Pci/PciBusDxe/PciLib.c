@@ -29,6 +29,13 @@ CHAR16 *mBarTypeStr[] = {
   L"Unknow"
   };
 
+//
+// Absent device maps of the root bridges, and the one selected for the root
+// bridge that is being scanned or whose resources are being collected.
+//
+LIST_ENTRY            mPciAbsentDeviceMapList = INITIALIZE_LIST_HEAD_VARIABLE (mPciAbsentDeviceMapList);
+PCI_ABSENT_DEVICE_MAP *mPciAbsentDeviceMap    = NULL;
+
 /**
   Retrieve the max bus number that is assigned to the Root Bridge hierarchy.
   It can support the case that there are multiple bus ranges.
@@ -986,6 +993,83 @@ PciAllocateBusNumber (
   return EFI_OUT_OF_RESOURCES;
 }
 
+/**
+  Select the absent device map of a root bridge as the map that PciScanBus()
+  records to and PciIsDeviceAbsent() looks up.
+
+  @param  RootBridgeHandle Handle of the root bridge, or NULL to select no map.
+  @param  Reset            TRUE to forget the devices recorded by a previous scan
+                           of the root bridge, creating the map if needed.
+
+**/
+VOID
+PciSelectAbsentDeviceMap (
+  IN EFI_HANDLE                         RootBridgeHandle,
+  IN BOOLEAN                            Reset
+  )
+{
+  LIST_ENTRY                            *Link;
+  PCI_ABSENT_DEVICE_MAP                 *Map;
+
+  mPciAbsentDeviceMap = NULL;
+
+  if (!FeaturePcdGet (PcdPciBusSkipAbsentDevices) || (RootBridgeHandle == NULL)) {
+    return;
+  }
+
+  for ( Link = GetFirstNode (&mPciAbsentDeviceMapList)
+      ; !IsNull (&mPciAbsentDeviceMapList, Link)
+      ; Link = GetNextNode (&mPciAbsentDeviceMapList, Link)
+      ) {
+    Map = PCI_ABSENT_DEVICE_MAP_FROM_LINK (Link);
+    if (Map->RootBridgeHandle == RootBridgeHandle) {
+      if (Reset) {
+        ZeroMem (Map->AbsentDevices, sizeof (Map->AbsentDevices));
+      }
+      mPciAbsentDeviceMap = Map;
+      return;
+    }
+  }
+
+  if (!Reset) {
+    return;
+  }
+
+  Map = AllocateZeroPool (sizeof (PCI_ABSENT_DEVICE_MAP));
+  if (Map == NULL) {
+    return;
+  }
+
+  Map->Signature        = PCI_ABSENT_DEVICE_MAP_SIGNATURE;
+  Map->RootBridgeHandle = RootBridgeHandle;
+  InsertTailList (&mPciAbsentDeviceMapList, &Map->Link);
+  mPciAbsentDeviceMap   = Map;
+}
+
+/**
+  Check whether a PCI device was found absent by the bus number assignment
+  scan of the root bridge whose resources are being collected.
+
+  @param  Bus              PCI bus NO.
+  @param  Device           PCI device NO.
+
+  @retval TRUE             The device has no function 0.
+  @retval FALSE            The device is present, or no scan result is available.
+
+**/
+BOOLEAN
+PciIsDeviceAbsent (
+  IN UINT8                              Bus,
+  IN UINT8                              Device
+  )
+{
+  if (mPciAbsentDeviceMap == NULL) {
+    return FALSE;
+  }
+
+  return (BOOLEAN) ((mPciAbsentDeviceMap->AbsentDevices[Bus] & (1u << Device)) != 0);
+}
+
 /**
   Scan pci bus and assign bus number to the given PCI bus system.
 
@@ -1056,8 +1140,12 @@ PciScanBus (
 
       if (EFI_ERROR (Status) && Func == 0) {
         //
-        // go to next device if there is no Function 0
+        // Record the absent device so that the resource collection does not
+        // probe it again, and go to next device if there is no Function 0
         //
+        if (mPciAbsentDeviceMap != NULL) {
+          mPciAbsentDeviceMap->AbsentDevices[StartBusNumber] |= (1u << Device);
+        }
         break;
       }
 
@@ -1506,12 +1594,16 @@ PciHostBridgeEnumerator (
     }
 
     //
-    // Enumerate all the buses under this root bridge
+    // Enumerate all the buses under this root bridge, recording the absent devices
     //
+    PERF_START (RootBridgeHandle, "PciBusScan", NULL, 0);
+    PciSelectAbsentDeviceMap (RootBridgeHandle, TRUE);
     Status = PciRootBridgeEnumerator (
               PciResAlloc,
               RootBridgeDev
               );
+    PciSelectAbsentDeviceMap (NULL, FALSE);
+    PERF_END (RootBridgeHandle, "PciBusScan", NULL, 0);
 
     if (gPciHotPlugInit != NULL && FeaturePcdGet (PcdPciBusHotplugDeviceSupport)) {
       InsertTailList (&RootBridgeList, &(RootBridgeDev->Link));
@@ -1597,12 +1689,16 @@ PciHostBridgeEnumerator (
       }
 
       //
-      // Enumerate all the buses under this root bridge
+      // Enumerate all the buses under this root bridge, recording the absent devices
       //
+      PERF_START (RootBridgeHandle, "PciBusScan", NULL, 0);
+      PciSelectAbsentDeviceMap (RootBridgeHandle, TRUE);
       Status = PciRootBridgeEnumerator (
                 PciResAlloc,
                 RootBridgeDev
                 );
+      PciSelectAbsentDeviceMap (NULL, FALSE);
+      PERF_END (RootBridgeHandle, "PciBusScan", NULL, 0);
 
       DestroyRootBridge (RootBridgeDev);
       if (EFI_ERROR (Status)) {
@@ -1668,12 +1764,17 @@ PciHostBridgeEnumerator (
     //
     // Collect all the resource information under this root bridge
     // A database that records all the information about pci device subject to this
-    // root bridge will then be created
+    // root bridge will then be created. The devices found absent by the bus scan
+    // are not probed again.
     //
+    PERF_START (RootBridgeHandle, "PciResCollect", NULL, 0);
+    PciSelectAbsentDeviceMap (RootBridgeHandle, FALSE);
     Status = PciPciDeviceInfoCollector (
               RootBridgeDev,
               (UINT8) MinBus
               );
+    PciSelectAbsentDeviceMap (NULL, FALSE);
+    PERF_END (RootBridgeHandle, "PciResCollect", NULL, 0);
 
     if (EFI_ERROR (Status)) {
       return Status;
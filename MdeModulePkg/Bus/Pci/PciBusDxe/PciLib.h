@@ -30,6 +30,22 @@ typedef struct {
   UINT8                              *AllocRes;
 } EFI_RESOURCE_ALLOC_FAILURE_ERROR_DATA_PAYLOAD;
 
+#define PCI_ABSENT_DEVICE_MAP_SIGNATURE  SIGNATURE_32 ('p', 'a', 'd', 'm')
+
+//
+// The devices without function 0 found by the bus number assignment scan
+// of one root bridge, one bit per device number for every bus number.
+//
+typedef struct {
+  UINT32                             Signature;
+  LIST_ENTRY                         Link;
+  EFI_HANDLE                         RootBridgeHandle;
+  UINT32                             AbsentDevices[PCI_MAX_BUS + 1];
+} PCI_ABSENT_DEVICE_MAP;
+
+#define PCI_ABSENT_DEVICE_MAP_FROM_LINK(a) \
+  CR (a, PCI_ABSENT_DEVICE_MAP, Link, PCI_ABSENT_DEVICE_MAP_SIGNATURE)
+
 
 /**
   Retrieve the PCI Card device BAR information via PciIo interface.
@@ -117,6 +133,23 @@ PciScanBus (
   OUT UINT8                             *PaddedBusRange
   );
 
+/**
+  Check whether a PCI device was found absent by the bus number assignment
+  scan of the root bridge whose resources are being collected.
+
+  @param  Bus              PCI bus NO.
+  @param  Device           PCI device NO.
+
+  @retval TRUE             The device has no function 0.
+  @retval FALSE            The device is present, or no scan result is available.
+
+**/
+BOOLEAN
+PciIsDeviceAbsent (
+  IN UINT8                              Bus,
+  IN UINT8                              Device
+  );
+
 /**
   Process Option Rom on the specified root bridge.
 
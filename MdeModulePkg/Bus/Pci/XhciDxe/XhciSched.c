@@ -233,6 +233,7 @@ XhcCreateTransferTrb (
   UINTN                         TotalLen;
   UINTN                         Len;
   UINTN                         TrbNum;
+  UINTN                         TdPacketCount;
   EFI_PCI_IO_PROTOCOL_OPERATION MapOp;
   EFI_PHYSICAL_ADDRESS          PhyAddr;
   VOID                          *Map;
@@ -377,24 +378,41 @@ XhcCreateTransferTrb (
 
     case ED_BULK_OUT:
     case ED_BULK_IN:
+      //
+      // The whole bulk transfer is posted as one TD of chained Normal TRBs, so
+      // the controller moves all the data without waiting for software between
+      // TRBs. Only the last TRB, or the TRB ending with a short packet, raises
+      // an event. A TRB buffer must not cross a 64KB boundary.
+      //
+      // The TD Size of a TRB is the number of packets of the TD that remain
+      // after the TRB, limited to 31, and 0 for the last TRB.
+      //
+      ASSERT (Urb->Ep.MaxPacket != 0);
+      TdPacketCount = (Urb->DataLen + Urb->Ep.MaxPacket - 1) / Urb->Ep.MaxPacket;
       TotalLen = 0;
       Len      = 0;
       TrbNum   = 0;
       TrbStart = (TRB *)(UINTN)EPRing->RingEnqueue;
       while (TotalLen < Urb->DataLen) {
-        if ((TotalLen + 0x10000) >= Urb->DataLen) {
+        Len = SIZE_64KB - (((UINTN) Urb->DataPhy + TotalLen) & (SIZE_64KB - 1));
+        if (Len > Urb->DataLen - TotalLen) {
           Len = Urb->DataLen - TotalLen;
-        } else {
-          Len = 0x10000;
         }
         TrbStart = (TRB *)(UINTN)EPRing->RingEnqueue;
         TrbStart->TrbNormal.TRBPtrLo  = XHC_LOW_32BIT((UINT8 *) Urb->DataPhy + TotalLen);
         TrbStart->TrbNormal.TRBPtrHi  = XHC_HIGH_32BIT((UINT8 *) Urb->DataPhy + TotalLen);
         TrbStart->TrbNormal.Length    = (UINT32) Len;
-        TrbStart->TrbNormal.TDSize    = 0;
         TrbStart->TrbNormal.IntTarget = 0;
         TrbStart->TrbNormal.ISP       = 1;
-        TrbStart->TrbNormal.IOC       = 1;
+        if (TotalLen + Len < Urb->DataLen) {
+          TrbStart->TrbNormal.TDSize  = (UINT32) MIN (31, TdPacketCount - (TotalLen + Len) / Urb->Ep.MaxPacket);
+          TrbStart->TrbNormal.CH      = 1;
+          TrbStart->TrbNormal.IOC     = 0;
+        } else {
+          TrbStart->TrbNormal.TDSize  = 0;
+          TrbStart->TrbNormal.CH      = 0;
+          TrbStart->TrbNormal.IOC     = 1;
+        }
         TrbStart->TrbNormal.Type      = TRB_TYPE_NORMAL;
         //
         // Update the cycle bit
@@ -1068,6 +1086,35 @@ IsAsyncIntTrb (
   return FALSE;
 }
 
+/**
+  Update the data length transferred by a bulk transfer from the event of one
+  of the Normal TRBs of its TD.
+
+  The event is generated for the TRB the TD ended at, so the data of the TRBs
+  before it has been transferred in full, and the event reports the residue
+  of the TRB itself.
+
+  @param  Urb             The bulk URB.
+  @param  Trb             The Normal TRB the event points to.
+  @param  EvtTrb          The transfer event.
+
+**/
+VOID
+XhcUpdateBulkCompleted (
+  IN  URB                 *Urb,
+  IN  TRB_TEMPLATE        *Trb,
+  IN  EVT_TRB_TRANSFER    *EvtTrb
+  )
+{
+  TRANSFER_TRB_NORMAL     *NormalTrb;
+  EFI_PHYSICAL_ADDRESS    PhyAddr;
+
+  NormalTrb = (TRANSFER_TRB_NORMAL *) Trb;
+  PhyAddr   = (EFI_PHYSICAL_ADDRESS) (NormalTrb->TRBPtrLo | LShiftU64 ((UINT64) NormalTrb->TRBPtrHi, 32));
+  Urb->Completed = (UINTN) (PhyAddr - (EFI_PHYSICAL_ADDRESS) (UINTN) Urb->DataPhy) +
+                   NormalTrb->Length - EvtTrb->Length;
+}
+
 
 /**
   Check the URB's execution result and update the URB's
@@ -1089,6 +1136,7 @@ XhcCheckUrbResult (
   TRB_TEMPLATE            *TRBPtr;
   UINTN                   Index;
   UINT8                   TRBType;
+  BOOLEAN                 BulkTrb;
   EFI_STATUS              Status;
   URB                     *AsyncUrb;
   URB                     *CheckedUrb;
@@ -1155,14 +1203,27 @@ XhcCheckUrbResult (
       continue;
     }
 
+    //
+    // A bulk transfer is one TD of chained Normal TRBs. Whether the TD completes
+    // or fails, the event points to the TRB it ended at.
+    //
+    TRBType = (UINT8) (TRBPtr->Type);
+    BulkTrb = (BOOLEAN) ((TRBType == TRB_TYPE_NORMAL) && (CheckedUrb->Ep.Type == XHC_BULK_TRANSFER));
+
     switch (EvtTrb->Completecode) {
       case TRB_COMPLETION_STALL_ERROR:
+        if (BulkTrb && !CheckedUrb->Finished) {
+          XhcUpdateBulkCompleted (CheckedUrb, TRBPtr, EvtTrb);
+        }
         CheckedUrb->Result  |= EFI_USB_ERR_STALL;
         CheckedUrb->Finished = TRUE;
         DEBUG ((EFI_D_ERROR, "XhcCheckUrbResult: STALL_ERROR! Completecode = %x\n",EvtTrb->Completecode));
         goto EXIT;
 
       case TRB_COMPLETION_BABBLE_ERROR:
+        if (BulkTrb && !CheckedUrb->Finished) {
+          XhcUpdateBulkCompleted (CheckedUrb, TRBPtr, EvtTrb);
+        }
         CheckedUrb->Result  |= EFI_USB_ERR_BABBLE;
         CheckedUrb->Finished = TRUE;
         DEBUG ((EFI_D_ERROR, "XhcCheckUrbResult: BABBLE_ERROR! Completecode = %x\n",EvtTrb->Completecode));
@@ -1175,6 +1236,9 @@ XhcCheckUrbResult (
         goto EXIT;
 
       case TRB_COMPLETION_USB_TRANSACTION_ERROR:
+        if (BulkTrb && !CheckedUrb->Finished) {
+          XhcUpdateBulkCompleted (CheckedUrb, TRBPtr, EvtTrb);
+        }
         CheckedUrb->Result  |= EFI_USB_ERR_TIMEOUT;
         CheckedUrb->Finished = TRUE;
         DEBUG ((EFI_D_ERROR, "XhcCheckUrbResult: TRANSACTION_ERROR! Completecode = %x\n",EvtTrb->Completecode));
@@ -1196,7 +1260,20 @@ XhcCheckUrbResult (
           DEBUG ((EFI_D_VERBOSE, "XhcCheckUrbResult: short packet happens!\n"));
         }
 
-        TRBType = (UINT8) (TRBPtr->Type);
+        if (BulkTrb) {
+          //
+          // The event of the last TRB, or of the TRB ending with a short packet,
+          // finishes the TD. A short packet may be followed by another event for
+          // the last TRB, which is ignored.
+          //
+          if (!CheckedUrb->Finished) {
+            XhcUpdateBulkCompleted (CheckedUrb, TRBPtr, EvtTrb);
+            CheckedUrb->Finished  = TRUE;
+            CheckedUrb->EvtTrb    = (TRB_TEMPLATE *) EvtTrb;
+          }
+          continue;
+        }
+
         if ((TRBType == TRB_TYPE_DATA_STAGE) ||
             (TRBType == TRB_TYPE_NORMAL) ||
             (TRBType == TRB_TYPE_ISOCH)) {
@@ -1927,6 +2004,10 @@ XhcSyncTrsRing (
     if ((UINT8) TrsTrb->Type == TRB_TYPE_LINK) {
       ASSERT (((LINK_TRB*)TrsTrb)->TC != 0);
       //
+      // The Link TRB is part of a TD which is chained across the end of the ring.
+      //
+      ((LINK_TRB*)TrsTrb)->CH = ((TRANSFER_TRB_NORMAL *) (TrsTrb - 1))->CH;
+      //
       // set cycle bit in Link TRB as normal
       //
       ((LINK_TRB*)TrsTrb)->CycleBit = TrsRing->RingPCS & BIT0;
@@ -69,6 +69,12 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 //
 #define USB_BOOT_MAX_CARRY_SIZE         SIZE_64KB
 
+//
+// SuperSpeed devices carry up to 1MB per command, so that the command and
+// status phases of each command stay small against its data phase.
+//
+#define USB_BOOT_MAX_CARRY_SIZE_SUPER_SPEED SIZE_1MB
+
 //
 // Retry mass command times, set by experience
 //
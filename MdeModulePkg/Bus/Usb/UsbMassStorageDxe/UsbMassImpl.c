@@ -461,6 +461,34 @@ ON_EXIT:
   return Status;
 }
 
+/**
+  Get the max number of bytes carried by one read/write command.
+
+  @param  UsbIo           The USB I/O Protocol instance of the device.
+
+  @return The max carry size, which is larger for SuperSpeed devices.
+
+**/
+UINT32
+UsbMassGetMaxCarrySize (
+  IN EFI_USB_IO_PROTOCOL           *UsbIo
+  )
+{
+  EFI_USB_DEVICE_DESCRIPTOR        DeviceDescriptor;
+  EFI_STATUS                       Status;
+
+  //
+  // A USB 3.x device reports a bcdUSB of 0x0210 when it does not operate at
+  // SuperSpeed.
+  //
+  Status = UsbIo->UsbGetDeviceDescriptor (UsbIo, &DeviceDescriptor);
+  if (!EFI_ERROR (Status) && (DeviceDescriptor.BcdUSB >= 0x0300)) {
+    return USB_BOOT_MAX_CARRY_SIZE_SUPER_SPEED;
+  }
+
+  return USB_BOOT_MAX_CARRY_SIZE;
+}
+
 /**
   Initialize data for device that supports multiple LUNSs.
 
@@ -491,10 +519,24 @@ UsbMassInitMultiLun (
   UINT8                            Index;
   EFI_STATUS                       Status;
   EFI_STATUS                       ReturnStatus;
+  UINT32                           MaxCarrySize;
 
   ASSERT (MaxLun > 0);
   ReturnStatus = EFI_NOT_FOUND;
 
+  MaxCarrySize = USB_BOOT_MAX_CARRY_SIZE;
+  Status = gBS->OpenProtocol (
+                  Controller,
+                  &gEfiUsbIoProtocolGuid,
+                  (VOID **) &UsbIo,
+                  This->DriverBindingHandle,
+                  Controller,
+                  EFI_OPEN_PROTOCOL_GET_PROTOCOL
+                  );
+  if (!EFI_ERROR (Status)) {
+    MaxCarrySize = UsbMassGetMaxCarrySize (UsbIo);
+  }
+
   for (Index = 0; Index <= MaxLun; Index++) {
 
     DEBUG ((EFI_D_INFO, "UsbMassInitMultiLun: Start to initialize No.%d logic unit\n", Index));
@@ -514,6 +556,7 @@ UsbMassInitMultiLun (
     UsbMass->Transport            = Transport;
     UsbMass->Context              = Context;
     UsbMass->Lun                  = Index;
+    UsbMass->MaxCarrySize         = MaxCarrySize;
 
     //
     // Initialize the media parameter data for EFI_BLOCK_IO_MEDIA of Block I/O Protocol.
@@ -654,6 +697,7 @@ UsbMassInitNonLun (
   UsbMass->OpticalStorage       = FALSE;
   UsbMass->Transport            = Transport;
   UsbMass->Context              = Context;
+  UsbMass->MaxCarrySize         = UsbMassGetMaxCarrySize (UsbIo);
 
   //
   // Initialize the media parameter data for EFI_BLOCK_IO_MEDIA of Block I/O Protocol.
@@ -417,6 +417,7 @@ CoreDispatcher (
   EFI_CORE_DRIVER_ENTRY           *DriverEntry;
   BOOLEAN                         ReadyToRun;
   EFI_EVENT                       DxeDispatchEvent;
+  UINTN                           DecodeCount;
 
   PERF_FUNCTION_BEGIN ();
 
@@ -443,10 +444,25 @@ CoreDispatcher (
 
   ReturnStatus = EFI_NOT_FOUND;
   do {
+    DecodeCount = 0;
+
     //
     // Drain the Scheduled Queue
     //
     while (!IsListEmpty (&mScheduledQueue)) {
+      if (FeaturePcdGet (PcdParallelSectionDecodeEnable)) {
+        if (DecodeCount == 0) {
+          //
+          // Decompress the sections of the next batch of scheduled files on
+          // the APs at once, so that loading them below finds them already
+          // decoded. Every iteration takes one entry off the queue head.
+          //
+          CoreFlushDecodedSections ();
+          DecodeCount = CoreDecodeScheduledSections (&mScheduledQueue);
+        }
+        DecodeCount--;
+      }
+
       DriverEntry = CR (
                       mScheduledQueue.ForwardLink,
                       EFI_CORE_DRIVER_ENTRY,
@@ -539,6 +555,10 @@ CoreDispatcher (
       ReturnStatus = EFI_SUCCESS;
     }
 
+    if (FeaturePcdGet (PcdParallelSectionDecodeEnable)) {
+      CoreFlushDecodedSections ();
+    }
+
     //
     // Now DXE Dispatcher finished one round of dispatch, signal an event group
     // so that SMM Dispatcher get chance to dispatch SMM Drivers which depend
@@ -53,6 +53,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Protocol/TcgService.h>
 #include <Protocol/HiiPackageList.h>
 #include <Protocol/SmmBase2.h>
+#include <Protocol/MpService.h>
 #include <Guid/MemoryTypeInformation.h>
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
@@ -174,6 +175,43 @@ typedef struct {
 
 } EFI_CORE_DRIVER_ENTRY;
 
+//
+//The node of a tree indexing the GCD maps or the memory map by address,
+//embedded in the structure it indexes
+//
+typedef struct _CORE_TREE_NODE CORE_TREE_NODE;
+struct _CORE_TREE_NODE {
+  CORE_TREE_NODE        *Parent;
+  CORE_TREE_NODE        *Left;
+  CORE_TREE_NODE        *Right;
+  UINT32                Priority;
+};
+
+/**
+  Recomputes the data a tree node keeps about its subtree from the node and
+  its children.
+
+  @param  Node              The node to update.
+
+**/
+typedef
+VOID
+(*CORE_TREE_UPDATE) (
+  IN CORE_TREE_NODE     *Node
+  );
+
+//
+//The tree is a treap: the in-order walk of the nodes follows the order of the
+//indexed structures, and the node priorities, drawn at random, keep it
+//balanced on average.
+//
+typedef struct {
+  CORE_TREE_NODE        *Root;
+  UINTN                 Count;
+  UINT32                Seed;
+  CORE_TREE_UPDATE      Update;           // NULL if nodes keep no subtree data
+} CORE_TREE;
+
 //
 //The data structure of GCD memory map entry
 //
@@ -189,6 +227,7 @@ typedef struct {
   EFI_GCD_IO_TYPE       GcdIoType;
   EFI_HANDLE            ImageHandle;
   EFI_HANDLE            DeviceHandle;
+  CORE_TREE_NODE        TreeNode;         // Same order as Link
 } EFI_GCD_MAP_ENTRY;
 
 
@@ -2177,6 +2216,17 @@ CoreDisplayDiscoveredNotDispatched (
   );
 
 
+/**
+  Displays the lookup counters of the protocol database.  Only used in Debug
+  Builds.
+
+**/
+VOID
+CoreDisplayProtocolDatabaseStatistics (
+  VOID
+  );
+
+
 
 /**
   Place holder function until all the Boot Services and Runtime Services are
@@ -2487,6 +2537,60 @@ CloseSectionStream (
   IN  BOOLEAN                                   FreeStreamBuffer
   );
 
+/**
+  Decode the encapsulation sections of a batch of files taken from the head
+  of the scheduled queue on the BSP and the enabled APs, and wait for the
+  decoding to complete. The jobs that fail are discarded, the others stay in
+  the cache until they are taken by the section extraction code or flushed.
+
+  Nothing is decoded if the MP Services Protocol is not installed yet or if
+  there is no enabled AP, the sections are then decoded on demand as usual.
+
+  @param  ScheduledQueue  The list of EFI_CORE_DRIVER_ENTRY about to be dispatched.
+
+  @return The number of entries at the head of ScheduledQueue covered by the
+          batch. The next batch should be decoded once they are dispatched.
+
+**/
+UINTN
+CoreDecodeScheduledSections (
+  IN LIST_ENTRY  *ScheduledQueue
+  );
+
+/**
+  Look for an encapsulation section in the decode cache. On success, the
+  decoded buffer is removed from the cache and owned by the caller.
+
+  @param  Section               The encapsulation section, including its header.
+  @param  SectionSize           The size of the section.
+  @param  OutputBuffer          Returns the pool buffer holding the decoded data.
+  @param  OutputSize            Returns the size of the decoded data.
+  @param  AuthenticationStatus  Returns the authentication status reported by
+                                the decoder of a GUIDed section.
+
+  @retval TRUE    The section was found in the cache.
+  @retval FALSE   The section must be decoded by the caller.
+
+**/
+BOOLEAN
+CoreTakeDecodedSection (
+  IN  CONST VOID  *Section,
+  IN  UINTN       SectionSize,
+  OUT VOID        **OutputBuffer,
+  OUT UINTN       *OutputSize,
+  OUT UINT32      *AuthenticationStatus
+  );
+
+/**
+  Free all the decoded sections that were not taken, and the file copies they
+  were decoded from.
+
+**/
+VOID
+CoreFlushDecodedSections (
+  VOID
+  );
+
 /**
   Creates and initializes the DebugImageInfo Table.  Also creates the configuration
   table and registers it into the system table.
@@ -2656,6 +2760,72 @@ CoreReleaseLock (
   IN EFI_LOCK  *Lock
   );
 
+
+/**
+  Inserts a node in a tree, next to the node it follows or precedes in the
+  order of the indexed structures.
+
+  @param  Tree               The tree.
+  @param  Node               The node to insert.
+  @param  Neighbor           The node next to Node, or NULL if the tree is
+                             empty.
+  @param  After              TRUE if Node follows Neighbor, FALSE if it
+                             precedes it.
+
+**/
+VOID
+CoreInsertTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node,
+  IN CORE_TREE_NODE  *Neighbor,
+  IN BOOLEAN         After
+  );
+
+
+/**
+  Removes a node from a tree.
+
+  @param  Tree               The tree.
+  @param  Node               The node to remove.
+
+**/
+VOID
+CoreRemoveTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node
+  );
+
+
+/**
+  Makes a copy of a node take the place of the node in a tree.
+
+  @param  Tree               The tree.
+  @param  Node               The node in the tree.
+  @param  NewNode            The copy of Node to link in its place.
+
+**/
+VOID
+CoreReplaceTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node,
+  IN CORE_TREE_NODE  *NewNode
+  );
+
+
+/**
+  Recomputes the subtree data of a node and of all its ancestors, after the
+  structure the node is embedded in has changed without changing its order.
+
+  @param  Tree               The tree.
+  @param  Node               The node whose structure changed.
+
+**/
+VOID
+CoreUpdateTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node
+  );
+
 /**
   Read data from Firmware Block by FVB protocol Read.
   The data may cross the multi block ranges.
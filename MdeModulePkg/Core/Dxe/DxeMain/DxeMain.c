@@ -766,6 +766,13 @@ CoreExitBootServices (
 
   gMemoryMapTerminated = TRUE;
 
+  //
+  // Display the protocol database lookup counters if this is a debug build
+  //
+  DEBUG_CODE_BEGIN ();
+    CoreDisplayProtocolDatabaseStatistics ();
+  DEBUG_CODE_END ();
+
   //
   // Notify other drivers that we are exiting boot services.
   //
@@ -1,6 +1,16 @@
 /** @file
   Core Timer Services
 
+  Timer events are kept in a hierarchical timer wheel, so that setting,
+  cancelling and expiring a timer does not depend on the number of timers.
+  The system time is divided in ticks of 2^TIMER_WHEEL_TICK_SHIFT 100ns
+  units. Each level of the wheel has TIMER_WHEEL_SLOTS slots, and a slot of
+  level N covers TIMER_WHEEL_SLOTS^N ticks. A timer is queued in the lowest
+  level where its trigger tick and the current tick only differ in the digit
+  of that level. The slots of level 0 are sorted by trigger time, so that
+  timers still expire in trigger time order. When the current tick enters a
+  new slot of a higher level, the timers of that slot are moved down.
+
 Copyright (c) 2006 - 2013, Intel Corporation. All rights reserved.<BR>
 This program and the accompanying materials
 are licensed and made available under the terms and conditions of the BSD License
@@ -16,6 +26,15 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "DxeMain.h"
 #include "Event.h"
 
+//
+// Timer wheel geometry. A tick is about 1.6ms and the 5 levels cover about
+// 20 days, timers further in the future wait in mEfiTimerList.
+//
+#define TIMER_WHEEL_TICK_SHIFT    14
+#define TIMER_WHEEL_SLOT_SHIFT    6
+#define TIMER_WHEEL_SLOTS         (1 << TIMER_WHEEL_SLOT_SHIFT)
+#define TIMER_WHEEL_LEVELS        5
+
 //
 // Internal data
 //
@@ -24,12 +43,47 @@ LIST_ENTRY       mEfiTimerList = INITIALIZE_LIST_HEAD_VARIABLE (mEfiTimerList);
 EFI_LOCK         mEfiTimerLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
 EFI_EVENT        mEfiCheckTimerEvent = NULL;
 
+LIST_ENTRY       mEfiTimerWheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+UINT64           mEfiTimerWheelBitmap[TIMER_WHEEL_LEVELS];
+UINT64           mEfiTimerWheelTick = 0;
+
+//
+// No timer expires before this time. It is a lower bound: cancelling a
+// timer does not raise it, the next check of the timers does.
+//
+UINT64           mEfiTimerNextTriggerTime = MAX_UINT64;
+
 EFI_LOCK         mEfiSystemTimeLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
 UINT64           mEfiSystemTime = 0;
 
 //
 // Timer functions
 //
+
+/**
+  Checks if no timer event is queued.
+
+  @retval TRUE                   The timer database is empty.
+  @retval FALSE                  At least one timer event is queued.
+
+**/
+STATIC
+BOOLEAN
+CoreIsTimerWheelEmpty (
+  VOID
+  )
+{
+  UINTN           Level;
+
+  for (Level = 0; Level < TIMER_WHEEL_LEVELS; Level++) {
+    if (mEfiTimerWheelBitmap[Level] != 0) {
+      return FALSE;
+    }
+  }
+
+  return IsListEmpty (&mEfiTimerList);
+}
+
 /**
   Inserts the timer event.
 
@@ -43,6 +97,9 @@ CoreInsertEventTimer (
   )
 {
   UINT64          TriggerTime;
+  UINT64          Tick;
+  UINTN           Level;
+  UINTN           Slot;
   LIST_ENTRY      *Link;
   IEVENT          *Event2;
 
@@ -52,11 +109,44 @@ CoreInsertEventTimer (
   // Get the timer's trigger time
   //
   TriggerTime = Event->Timer.TriggerTime;
+  Tick        = RShiftU64 (TriggerTime, TIMER_WHEEL_TICK_SHIFT);
+
+  if (TriggerTime < mEfiTimerNextTriggerTime) {
+    mEfiTimerNextTriggerTime = TriggerTime;
+  }
 
   //
-  // Insert the timer into the timer database in assending sorted order
+  // Find the lowest level where the trigger tick and the current tick share
+  // all the upper digits. A timer that is already due goes to the current
+  // slot of level 0.
   //
-  for (Link = mEfiTimerList.ForwardLink; Link != &mEfiTimerList; Link = Link->ForwardLink) {
+  if (Tick <= mEfiTimerWheelTick) {
+    Tick = mEfiTimerWheelTick;
+  }
+  for (Level = 0; Level < TIMER_WHEEL_LEVELS; Level++) {
+    if (RShiftU64 (Tick, TIMER_WHEEL_SLOT_SHIFT * (Level + 1)) ==
+        RShiftU64 (mEfiTimerWheelTick, TIMER_WHEEL_SLOT_SHIFT * (Level + 1))) {
+      break;
+    }
+  }
+
+  if (Level == TIMER_WHEEL_LEVELS) {
+    InsertTailList (&mEfiTimerList, &Event->Timer.Link);
+    return;
+  }
+
+  Slot = (UINTN) RShiftU64 (Tick, TIMER_WHEEL_SLOT_SHIFT * Level) & (TIMER_WHEEL_SLOTS - 1);
+  mEfiTimerWheelBitmap[Level] |= LShiftU64 (1, Slot);
+
+  if (Level != 0) {
+    InsertTailList (&mEfiTimerWheel[Level][Slot], &Event->Timer.Link);
+    return;
+  }
+
+  //
+  // Insert the timer into the level 0 slot in assending sorted order
+  //
+  for (Link = mEfiTimerWheel[0][Slot].ForwardLink; Link != &mEfiTimerWheel[0][Slot]; Link = Link->ForwardLink) {
     Event2 = CR (Link, IEVENT, Timer.Link, EVENT_SIGNATURE);
 
     if (Event2->Timer.TriggerTime > TriggerTime) {
@@ -67,6 +157,93 @@ CoreInsertEventTimer (
   InsertTailList (Link, &Event->Timer.Link);
 }
 
+/**
+  Removes the timer event from the timer database.
+
+  @param  Event                  Points to the internal structure of timer event
+                                 to be removed
+
+**/
+STATIC
+VOID
+CoreRemoveEventTimer (
+  IN IEVENT   *Event
+  )
+{
+  LIST_ENTRY      *Next;
+  UINTN           Index;
+
+  ASSERT_LOCKED (&mEfiTimerLock);
+
+  Next = RemoveEntryList (&Event->Timer.Link);
+  Event->Timer.Link.ForwardLink = NULL;
+
+  //
+  // If the timer was the last one of a wheel slot, Next is the head of the
+  // slot, which is then marked empty.
+  //
+  if (IsListEmpty (Next) &&
+      (Next >= &mEfiTimerWheel[0][0]) &&
+      (Next <= &mEfiTimerWheel[TIMER_WHEEL_LEVELS - 1][TIMER_WHEEL_SLOTS - 1])) {
+    Index = Next - &mEfiTimerWheel[0][0];
+    mEfiTimerWheelBitmap[Index / TIMER_WHEEL_SLOTS] &= ~LShiftU64 (1, Index % TIMER_WHEEL_SLOTS);
+  }
+}
+
+/**
+  Moves down the timers of the upper level slots that the current tick just
+  entered. Called each time the current tick crosses a level 0 boundary.
+
+**/
+STATIC
+VOID
+CoreCascadeEventTimers (
+  VOID
+  )
+{
+  UINTN           Level;
+  UINTN           Slot;
+  LIST_ENTRY      Timers;
+  IEVENT          *Event;
+
+  ASSERT_LOCKED (&mEfiTimerLock);
+
+  InitializeListHead (&Timers);
+
+  //
+  // Find the levels whose digit changed, and also take the far timers when
+  // the top level wraps.
+  //
+  for (Level = 1; Level < TIMER_WHEEL_LEVELS; Level++) {
+    if ((mEfiTimerWheelTick & (LShiftU64 (1, TIMER_WHEEL_SLOT_SHIFT * Level) - 1)) != 0) {
+      break;
+    }
+  }
+  if ((Level == TIMER_WHEEL_LEVELS) &&
+      ((mEfiTimerWheelTick & (LShiftU64 (1, TIMER_WHEEL_SLOT_SHIFT * TIMER_WHEEL_LEVELS) - 1)) == 0)) {
+    while (!IsListEmpty (&mEfiTimerList)) {
+      Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+      RemoveEntryList (&Event->Timer.Link);
+      InsertTailList (&Timers, &Event->Timer.Link);
+    }
+  }
+  while (--Level > 0) {
+    Slot = (UINTN) RShiftU64 (mEfiTimerWheelTick, TIMER_WHEEL_SLOT_SHIFT * Level) & (TIMER_WHEEL_SLOTS - 1);
+    while (!IsListEmpty (&mEfiTimerWheel[Level][Slot])) {
+      Event = CR (mEfiTimerWheel[Level][Slot].ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+      RemoveEntryList (&Event->Timer.Link);
+      InsertTailList (&Timers, &Event->Timer.Link);
+    }
+    mEfiTimerWheelBitmap[Level] &= ~LShiftU64 (1, Slot);
+  }
+
+  while (!IsListEmpty (&Timers)) {
+    Event = CR (Timers.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+    RemoveEntryList (&Event->Timer.Link);
+    CoreInsertEventTimer (Event);
+  }
+}
+
 /**
   Returns the current system time.
 
@@ -88,31 +265,24 @@ CoreCurrentSystemTime (
 }
 
 /**
-  Checks the sorted timer list against the current system time.
-  Signals any expired event timer.
+  Signals the expired event timers of the current level 0 slot.
 
-  @param  CheckEvent             Not used
-  @param  Context                Not used
+  @param  SystemTime             The current system time
 
 **/
+STATIC
 VOID
-EFIAPI
-CoreCheckTimers (
-  IN EFI_EVENT            CheckEvent,
-  IN VOID                 *Context
+CoreSignalExpiredTimers (
+  IN UINT64               SystemTime
   )
 {
-  UINT64                  SystemTime;
+  LIST_ENTRY              *Head;
   IEVENT                  *Event;
 
-  //
-  // Check the timer database for expired timers
-  //
-  CoreAcquireLock (&mEfiTimerLock);
-  SystemTime = CoreCurrentSystemTime ();
+  Head = &mEfiTimerWheel[0][(UINTN) mEfiTimerWheelTick & (TIMER_WHEEL_SLOTS - 1)];
 
-  while (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  while (!IsListEmpty (Head)) {
+    Event = CR (Head->ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
 
     //
     // If this timer is not expired, then we're done
@@ -125,8 +295,7 @@ CoreCheckTimers (
     // Remove this timer from the timer queue
     //
 
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    CoreRemoveEventTimer (Event);
 
     //
     // Signal it
@@ -156,6 +325,89 @@ CoreCheckTimers (
       CoreInsertEventTimer (Event);
     }
   }
+}
+
+/**
+  Checks the timer wheel against the current system time.
+  Signals any expired event timer.
+
+  @param  CheckEvent             Not used
+  @param  Context                Not used
+
+**/
+VOID
+EFIAPI
+CoreCheckTimers (
+  IN EFI_EVENT            CheckEvent,
+  IN VOID                 *Context
+  )
+{
+  UINT64                  SystemTime;
+  UINT64                  Tick;
+  UINT64                  NextTick;
+  UINT64                  Pending;
+  UINTN                   Slot;
+  IEVENT                  *Event;
+
+  //
+  // Check the timer database for expired timers
+  //
+  CoreAcquireLock (&mEfiTimerLock);
+  SystemTime = CoreCurrentSystemTime ();
+  Tick       = RShiftU64 (SystemTime, TIMER_WHEEL_TICK_SHIFT);
+
+  CoreSignalExpiredTimers (SystemTime);
+
+  //
+  // Advance the wheel up to the current tick, stopping only at the level 0
+  // slots holding timers and at the level 0 boundaries, where the upper
+  // levels are cascaded.
+  //
+  while (mEfiTimerWheelTick < Tick) {
+    if (CoreIsTimerWheelEmpty ()) {
+      mEfiTimerWheelTick = Tick;
+      break;
+    }
+
+    Slot    = (UINTN) mEfiTimerWheelTick & (TIMER_WHEEL_SLOTS - 1);
+    Pending = mEfiTimerWheelBitmap[0] & ~(LShiftU64 (2, Slot) - 1);
+    if (Pending != 0) {
+      NextTick = (mEfiTimerWheelTick & ~((UINT64) TIMER_WHEEL_SLOTS - 1)) + LowBitSet64 (Pending);
+    } else {
+      NextTick = (mEfiTimerWheelTick | (TIMER_WHEEL_SLOTS - 1)) + 1;
+    }
+
+    if (NextTick > Tick) {
+      mEfiTimerWheelTick = Tick;
+      break;
+    }
+
+    mEfiTimerWheelTick = NextTick;
+    if ((mEfiTimerWheelTick & (TIMER_WHEEL_SLOTS - 1)) == 0) {
+      CoreCascadeEventTimers ();
+    }
+    CoreSignalExpiredTimers (SystemTime);
+  }
+
+  //
+  // Compute when CoreTimerTick() should check the timers again: the first
+  // timer of the current slot, else the next non empty level 0 slot, else the
+  // next level 0 boundary if any timer sits in an upper level.
+  //
+  Slot    = (UINTN) mEfiTimerWheelTick & (TIMER_WHEEL_SLOTS - 1);
+  Pending = mEfiTimerWheelBitmap[0] & ~(LShiftU64 (2, Slot) - 1);
+  if (!IsListEmpty (&mEfiTimerWheel[0][Slot])) {
+    Event = CR (mEfiTimerWheel[0][Slot].ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+    mEfiTimerNextTriggerTime = Event->Timer.TriggerTime;
+  } else if (Pending != 0) {
+    NextTick = (mEfiTimerWheelTick & ~((UINT64) TIMER_WHEEL_SLOTS - 1)) + LowBitSet64 (Pending);
+    mEfiTimerNextTriggerTime = LShiftU64 (NextTick, TIMER_WHEEL_TICK_SHIFT);
+  } else if (!CoreIsTimerWheelEmpty ()) {
+    NextTick = (mEfiTimerWheelTick | (TIMER_WHEEL_SLOTS - 1)) + 1;
+    mEfiTimerNextTriggerTime = LShiftU64 (NextTick, TIMER_WHEEL_TICK_SHIFT);
+  } else {
+    mEfiTimerNextTriggerTime = MAX_UINT64;
+  }
 
   CoreReleaseLock (&mEfiTimerLock);
 }
@@ -171,6 +423,14 @@ CoreInitializeTimer (
   )
 {
   EFI_STATUS  Status;
+  UINTN       Level;
+  UINTN       Slot;
+
+  for (Level = 0; Level < TIMER_WHEEL_LEVELS; Level++) {
+    for (Slot = 0; Slot < TIMER_WHEEL_SLOTS; Slot++) {
+      InitializeListHead (&mEfiTimerWheel[Level][Slot]);
+    }
+  }
 
   Status = CoreCreateEventInternal (
              EVT_NOTIFY_SIGNAL,
@@ -197,8 +457,6 @@ CoreTimerTick (
   IN UINT64   Duration
   )
 {
-  IEVENT          *Event;
-
   //
   // Check runtiem flag in case there are ticks while exiting boot services
   //
@@ -210,15 +468,11 @@ CoreTimerTick (
   mEfiSystemTime += Duration;
 
   //
-  // If the head of the list is expired, fire the timer event
+  // If the earliest timer may be expired, fire the timer event
   // to process it
   //
-  if (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
-
-    if (Event->Timer.TriggerTime <= mEfiSystemTime) {
-      CoreSignalEvent (mEfiCheckTimerEvent);
-    }
+  if (mEfiTimerNextTriggerTime <= mEfiSystemTime) {
+    CoreSignalEvent (mEfiCheckTimerEvent);
   }
 
   CoreReleaseLock (&mEfiSystemTimeLock);
@@ -271,8 +525,7 @@ CoreSetTimer (
   // If the timer is queued to the timer database, remove it
   //
   if (Event->Timer.Link.ForwardLink != NULL) {
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    CoreRemoveEventTimer (Event);
   }
 
   Event->Timer.TriggerTime = 0;
@@ -287,6 +540,14 @@ CoreSetTimer (
       Event->Timer.Period = TriggerTime;
     }
 
+    //
+    // The wheel is not advanced while it is empty, so catch up with the
+    // system time before queuing the first timer.
+    //
+    if (CoreIsTimerWheelEmpty ()) {
+      mEfiTimerWheelTick = RShiftU64 (CoreCurrentSystemTime (), TIMER_WHEEL_TICK_SHIFT);
+    }
+
     Event->Timer.TriggerTime = CoreCurrentSystemTime () + TriggerTime;
     CoreInsertEventTimer (Event);
 
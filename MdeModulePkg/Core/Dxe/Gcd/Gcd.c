@@ -55,6 +55,8 @@ EFI_LOCK           mGcdMemorySpaceLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIF
 EFI_LOCK           mGcdIoSpaceLock     = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 LIST_ENTRY         mGcdMemorySpaceMap  = INITIALIZE_LIST_HEAD_VARIABLE (mGcdMemorySpaceMap);
 LIST_ENTRY         mGcdIoSpaceMap      = INITIALIZE_LIST_HEAD_VARIABLE (mGcdIoSpaceMap);
+CORE_TREE          mGcdMemorySpaceTree = { NULL, 0, 0x2545F491, NULL };
+CORE_TREE          mGcdIoSpaceTree     = { NULL, 0, 0x2545F491, NULL };
 
 EFI_GCD_MAP_ENTRY mGcdMemorySpaceMapEntryTemplate = {
   EFI_GCD_MAP_SIGNATURE,
@@ -69,7 +71,13 @@ EFI_GCD_MAP_ENTRY mGcdMemorySpaceMapEntryTemplate = {
   EfiGcdMemoryTypeNonExistent,
   (EFI_GCD_IO_TYPE) 0,
   NULL,
-  NULL
+  NULL,
+  {
+    NULL,
+    NULL,
+    NULL,
+    0
+  }
 };
 
 EFI_GCD_MAP_ENTRY mGcdIoSpaceMapEntryTemplate = {
@@ -85,7 +93,13 @@ EFI_GCD_MAP_ENTRY mGcdIoSpaceMapEntryTemplate = {
   (EFI_GCD_MEMORY_TYPE) 0,
   EfiGcdIoTypeNonExistent,
   NULL,
-  NULL
+  NULL,
+  {
+    NULL,
+    NULL,
+    NULL,
+    0
+  }
 };
 
 GCD_ATTRIBUTE_CONVERSION_ENTRY mAttributeConversionTable[] = {
@@ -374,6 +388,64 @@ PageAlignLength (
 // GCD Memory Space Worker Functions
 //
 
+/**
+  Internal function.  Returns the tree indexing a GCD map.
+
+  @param  Map                    The GCD memory space map or I/O space map.
+
+  @return The tree indexing the entries of Map.
+
+**/
+STATIC
+CORE_TREE *
+CoreGetGcdMapTree (
+  IN LIST_ENTRY  *Map
+  )
+{
+  if (Map == &mGcdIoSpaceMap) {
+    return &mGcdIoSpaceTree;
+  }
+
+  ASSERT (Map == &mGcdMemorySpaceMap);
+  return &mGcdMemorySpaceTree;
+}
+
+
+/**
+  Internal function.  Finds the GCD map entry covering an address.
+
+  @param  Tree                   The tree of the map.
+  @param  Address                The address to look up.
+
+  @return The entry covering Address, or NULL if Address is beyond the map.
+
+**/
+STATIC
+EFI_GCD_MAP_ENTRY *
+CoreFindGcdMapTreeEntry (
+  IN CORE_TREE             *Tree,
+  IN EFI_PHYSICAL_ADDRESS  Address
+  )
+{
+  CORE_TREE_NODE     *Node;
+  EFI_GCD_MAP_ENTRY  *Entry;
+
+  Node = Tree->Root;
+  while (Node != NULL) {
+    Entry = CR (Node, EFI_GCD_MAP_ENTRY, TreeNode, EFI_GCD_MAP_SIGNATURE);
+    if (Address < Entry->BaseAddress) {
+      Node = Node->Left;
+    } else if (Address > Entry->EndAddress) {
+      Node = Node->Right;
+    } else {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
+
 /**
   Allocate pool for two entries.
 
@@ -424,6 +496,7 @@ CoreAllocateGcdMapEntry (
   @param  Length                 The length of the new range in bytes
   @param  TopEntry               Top pad entry to insert if needed.
   @param  BottomEntry            Bottom pad entry to insert if needed.
+  @param  Map                    The GCD map Link belongs to.
 
   @retval EFI_SUCCESS            The new range was inserted into the linked list
 
@@ -435,7 +508,8 @@ CoreInsertGcdMapEntry (
   IN EFI_PHYSICAL_ADDRESS  BaseAddress,
   IN UINT64                Length,
   IN EFI_GCD_MAP_ENTRY     *TopEntry,
-  IN EFI_GCD_MAP_ENTRY     *BottomEntry
+  IN EFI_GCD_MAP_ENTRY     *BottomEntry,
+  IN LIST_ENTRY            *Map
   )
 {
   ASSERT (Length != 0);
@@ -447,6 +521,7 @@ CoreInsertGcdMapEntry (
     Entry->BaseAddress      = BaseAddress;
     BottomEntry->EndAddress = BaseAddress - 1;
     InsertTailList (Link, &BottomEntry->Link);
+    CoreInsertTreeNode (CoreGetGcdMapTree (Map), &BottomEntry->TreeNode, &Entry->TreeNode, FALSE);
   }
 
   if ((BaseAddress + Length - 1) < Entry->EndAddress) {
@@ -456,6 +531,7 @@ CoreInsertGcdMapEntry (
     TopEntry->BaseAddress = BaseAddress + Length;
     Entry->EndAddress     = BaseAddress + Length - 1;
     InsertHeadList (Link, &TopEntry->Link);
+    CoreInsertTreeNode (CoreGetGcdMapTree (Map), &TopEntry->TreeNode, &Entry->TreeNode, TRUE);
   }
 
   return EFI_SUCCESS;
@@ -529,6 +605,7 @@ CoreMergeGcdMapEntry (
     Entry->BaseAddress = AdjacentEntry->BaseAddress;
   }
   RemoveEntryList (AdjacentLink);
+  CoreRemoveTreeNode (CoreGetGcdMapTree (Map), &AdjacentEntry->TreeNode);
   CoreFreePool (AdjacentEntry);
 
   return EFI_SUCCESS;
@@ -600,31 +677,34 @@ CoreSearchGcdMapEntry (
   IN  LIST_ENTRY            *Map
   )
 {
-  LIST_ENTRY         *Link;
-  EFI_GCD_MAP_ENTRY  *Entry;
+  CORE_TREE          *Tree;
+  EFI_GCD_MAP_ENTRY  *StartEntry;
+  EFI_GCD_MAP_ENTRY  *EndEntry;
 
   ASSERT (Length != 0);
 
   *StartLink = NULL;
   *EndLink   = NULL;
 
-  Link = Map->ForwardLink;
-  while (Link != Map) {
-    Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
-    if (BaseAddress >= Entry->BaseAddress && BaseAddress <= Entry->EndAddress) {
-      *StartLink = Link;
-    }
-    if (*StartLink != NULL) {
-      if ((BaseAddress + Length - 1) >= Entry->BaseAddress &&
-          (BaseAddress + Length - 1) <= Entry->EndAddress     ) {
-        *EndLink = Link;
-        return EFI_SUCCESS;
-      }
-    }
-    Link = Link->ForwardLink;
+  Tree = CoreGetGcdMapTree (Map);
+
+  StartEntry = CoreFindGcdMapTreeEntry (Tree, BaseAddress);
+  if (StartEntry == NULL) {
+    return EFI_NOT_FOUND;
   }
 
-  return EFI_NOT_FOUND;
+  //
+  // The end entry must not precede the start entry, which happens when the
+  // range wraps around the address space.
+  //
+  EndEntry = CoreFindGcdMapTreeEntry (Tree, BaseAddress + Length - 1);
+  if (EndEntry == NULL || EndEntry->BaseAddress < StartEntry->BaseAddress) {
+    return EFI_NOT_FOUND;
+  }
+
+  *StartLink = &StartEntry->Link;
+  *EndLink   = &EndEntry->Link;
+  return EFI_SUCCESS;
 }
 
 
@@ -641,17 +721,7 @@ CoreCountGcdMapEntry (
   IN LIST_ENTRY  *Map
   )
 {
-  UINTN           Count;
-  LIST_ENTRY      *Link;
-
-  Count = 0;
-  Link = Map->ForwardLink;
-  while (Link != Map) {
-    Count++;
-    Link = Link->ForwardLink;
-  }
-
-  return Count;
+  return CoreGetGcdMapTree (Map)->Count;
 }
 
 
@@ -914,7 +984,7 @@ CoreConvertSpace (
   Link = StartLink;
   while (Link != EndLink->ForwardLink) {
     Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
-    CoreInsertGcdMapEntry (Link, Entry, BaseAddress, Length, TopEntry, BottomEntry);
+    CoreInsertGcdMapEntry (Link, Entry, BaseAddress, Length, TopEntry, BottomEntry, Map);
     switch (Operation) {
     //
     // Add operations
@@ -1276,7 +1346,7 @@ CoreAllocateSpace (
   Link = StartLink;
   while (Link != EndLink->ForwardLink) {
     Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
-    CoreInsertGcdMapEntry (Link, Entry, *BaseAddress, Length, TopEntry, BottomEntry);
+    CoreInsertGcdMapEntry (Link, Entry, *BaseAddress, Length, TopEntry, BottomEntry, Map);
     Entry->ImageHandle  = ImageHandle;
     Entry->DeviceHandle = DeviceHandle;
     Link = Link->ForwardLink;
@@ -2438,6 +2508,7 @@ CoreInitializeGcdServices (
   Entry->EndAddress = LShiftU64 (1, SizeOfMemorySpace) - 1;
 
   InsertHeadList (&mGcdMemorySpaceMap, &Entry->Link);
+  CoreInsertTreeNode (&mGcdMemorySpaceTree, &Entry->TreeNode, NULL, FALSE);
 
   CoreDumpGcdMemorySpaceMap (TRUE);
 
@@ -2450,6 +2521,7 @@ CoreInitializeGcdServices (
   Entry->EndAddress = LShiftU64 (1, SizeOfIoSpace) - 1;
 
   InsertHeadList (&mGcdIoSpaceMap, &Entry->Link);
+  CoreInsertTreeNode (&mGcdIoSpaceTree, &Entry->TreeNode, NULL, FALSE);
 
   CoreDumpGcdIoSpaceMap (TRUE);
 
@@ -16,16 +16,26 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "Handle.h"
 
 
+//
+// Number of buckets of the protocol GUID hash index, must be a power of 2
+//
+#define PROTOCOL_HASH_TABLE_SIZE  0x40
+
 //
 // mProtocolDatabase     - A list of all protocols in the system.  (simple list for now)
+// mProtocolHashTable    - The protocols of mProtocolDatabase hashed by GUID
 // gHandleList           - A list of all the handles in the system
 // gProtocolDatabaseLock - Lock to protect the mProtocolDatabase
 // gHandleDatabaseKey    -  The Key to show that the handle has been created/modified
+// gProtocolDatabaseStatistics - Lookup counters of mProtocolHashTable
 //
 LIST_ENTRY      mProtocolDatabase     = INITIALIZE_LIST_HEAD_VARIABLE (mProtocolDatabase);
+LIST_ENTRY      mProtocolHashTable[PROTOCOL_HASH_TABLE_SIZE];
+BOOLEAN         mProtocolHashTableInitialized = FALSE;
 LIST_ENTRY      gHandleList           = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
 EFI_LOCK        gProtocolDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 UINT64          gHandleDatabaseKey    = 0;
+PROTOCOL_DATABASE_STATISTICS  gProtocolDatabaseStatistics;
 
 
 
@@ -90,6 +100,45 @@ CoreValidateHandle (
 
 
 
+/**
+  Get the bucket of mProtocolHashTable for a protocol GUID.
+
+  @param  Protocol               The ID of the protocol
+
+  @return The head of the bucket list
+
+**/
+STATIC
+LIST_ENTRY *
+CoreGetProtocolHashBucket (
+  IN EFI_GUID   *Protocol
+  )
+{
+  UINT32              Hash;
+  UINTN               Index;
+
+  if (!mProtocolHashTableInitialized) {
+    for (Index = 0; Index < PROTOCOL_HASH_TABLE_SIZE; Index++) {
+      InitializeListHead (&mProtocolHashTable[Index]);
+    }
+    mProtocolHashTableInitialized = TRUE;
+  }
+
+  //
+  // Fold the 128-bit GUID into the bucket index
+  //
+  Hash = ReadUnaligned32 ((UINT32 *) Protocol) ^
+         ReadUnaligned32 ((UINT32 *) Protocol + 1) ^
+         ReadUnaligned32 ((UINT32 *) Protocol + 2) ^
+         ReadUnaligned32 ((UINT32 *) Protocol + 3);
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 8;
+
+  return &mProtocolHashTable[Hash & (PROTOCOL_HASH_TABLE_SIZE - 1)];
+}
+
+
+
 /**
   Finds the protocol entry for the requested protocol.
   The gProtocolDatabaseLock must be owned
@@ -106,22 +155,27 @@ CoreFindProtocolEntry (
   IN BOOLEAN    Create
   )
 {
+  LIST_ENTRY          *Bucket;
   LIST_ENTRY          *Link;
   PROTOCOL_ENTRY      *Item;
   PROTOCOL_ENTRY      *ProtEntry;
+  UINTN               ProbeLength;
 
   ASSERT_LOCKED(&gProtocolDatabaseLock);
 
   //
-  // Search the database for the matching GUID
+  // Search the hash bucket of the GUID for the matching entry
   //
 
-  ProtEntry = NULL;
-  for (Link = mProtocolDatabase.ForwardLink;
-       Link != &mProtocolDatabase;
+  ProtEntry   = NULL;
+  ProbeLength = 0;
+  Bucket      = CoreGetProtocolHashBucket (Protocol);
+  for (Link = Bucket->ForwardLink;
+       Link != Bucket;
        Link = Link->ForwardLink) {
 
-    Item = CR(Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+    ProbeLength++;
+    Item = CR(Link, PROTOCOL_ENTRY, HashLink, PROTOCOL_ENTRY_SIGNATURE);
     if (CompareGuid (&Item->ProtocolID, Protocol)) {
 
       //
@@ -133,6 +187,14 @@ CoreFindProtocolEntry (
     }
   }
 
+  DEBUG_CODE_BEGIN ();
+    gProtocolDatabaseStatistics.LookupCount++;
+    gProtocolDatabaseStatistics.ProbeCount += ProbeLength;
+    if (ProbeLength > gProtocolDatabaseStatistics.MaxProbeLength) {
+      gProtocolDatabaseStatistics.MaxProbeLength = ProbeLength;
+    }
+  DEBUG_CODE_END ();
+
   //
   // If the protocol entry was not found and Create is TRUE, then
   // allocate a new entry
@@ -148,11 +210,13 @@ CoreFindProtocolEntry (
       CopyGuid ((VOID *)&ProtEntry->ProtocolID, Protocol);
       InitializeListHead (&ProtEntry->Protocols);
       InitializeListHead (&ProtEntry->Notify);
+      ProtEntry->InterfaceCount = 0;
 
       //
       // Add it to protocol database
       //
       InsertTailList (&mProtocolDatabase, &ProtEntry->AllEntries);
+      InsertTailList (Bucket, &ProtEntry->HashLink);
     }
   }
 
@@ -161,6 +225,28 @@ CoreFindProtocolEntry (
 
 
 
+/**
+  Displays the lookup counters of the protocol database.  Only used in Debug
+  Builds.
+
+**/
+VOID
+CoreDisplayProtocolDatabaseStatistics (
+  VOID
+  )
+{
+  DEBUG ((
+    DEBUG_INFO,
+    "Protocol database: %ld lookups, %ld probes, longest probe %ld, %ld single pass LocateHandleBuffer\n",
+    gProtocolDatabaseStatistics.LookupCount,
+    gProtocolDatabaseStatistics.ProbeCount,
+    gProtocolDatabaseStatistics.MaxProbeLength,
+    gProtocolDatabaseStatistics.LocateBufferSinglePassCount
+    ));
+}
+
+
+
 /**
   Finds the protocol instance for the requested handle and protocol.
   Note: This function doesn't do parameters checking, it's caller's responsibility
@@ -471,6 +557,7 @@ CoreInstallProtocolInterfaceNotify (
   // protocol entry
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
+  ProtEntry->InterfaceCount++;
 
   //
   // Notify the notification list for this protocol
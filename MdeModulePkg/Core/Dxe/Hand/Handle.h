@@ -45,15 +45,34 @@ typedef struct {
   UINTN               Signature;
   /// Link Entry inserted to mProtocolDatabase
   LIST_ENTRY          AllEntries;
+  /// Link Entry inserted to the mProtocolHashTable bucket of ProtocolID
+  LIST_ENTRY          HashLink;
   /// ID of the protocol
   EFI_GUID            ProtocolID;
   /// All protocol interfaces
   LIST_ENTRY          Protocols;
+  /// Number of protocol interfaces on Protocols
+  UINTN               InterfaceCount;
   /// Registerd notification handlers
   LIST_ENTRY          Notify;
 } PROTOCOL_ENTRY;
 
 
+///
+/// PROTOCOL_DATABASE_STATISTICS - counters of the protocol entry lookups
+///
+typedef struct {
+  /// Number of CoreFindProtocolEntry() calls
+  UINT64              LookupCount;
+  /// Number of protocol entries compared by all the lookups
+  UINT64              ProbeCount;
+  /// Longest number of protocol entries compared by one lookup
+  UINT64              MaxProbeLength;
+  /// Number of CoreLocateHandleBuffer() calls sized from InterfaceCount
+  UINT64              LocateBufferSinglePassCount;
+} PROTOCOL_DATABASE_STATISTICS;
+
+
 #define PROTOCOL_INTERFACE_SIGNATURE  SIGNATURE_32('p','i','f','c')
 
 ///
@@ -266,5 +285,6 @@ CoreValidateHandle (
 extern EFI_LOCK         gProtocolDatabaseLock;
 extern LIST_ENTRY       gHandleList;
 extern UINT64           gHandleDatabaseKey;
+extern PROTOCOL_DATABASE_STATISTICS  gProtocolDatabaseStatistics;
 
 #endif
@@ -651,6 +651,7 @@ CoreLocateHandleBuffer (
 {
   EFI_STATUS          Status;
   UINTN               BufferSize;
+  PROTOCOL_ENTRY      *ProtEntry;
 
   if (NumberHandles == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -663,38 +664,70 @@ CoreLocateHandleBuffer (
   BufferSize = 0;
   *NumberHandles = 0;
   *Buffer = NULL;
-  Status = CoreLocateHandle (
-             SearchType,
-             Protocol,
-             SearchKey,
-             &BufferSize,
-             *Buffer
-             );
-  //
-  // LocateHandleBuffer() returns incorrect status code if SearchType is
-  // invalid.
+
   //
-  // Add code to correctly handle expected errors from CoreLocateHandle().
+  // A handle supports a protocol at most once, so the interface count of the
+  // protocol entry gives the buffer size without a sizing pass
   //
-  if (EFI_ERROR(Status) && Status != EFI_BUFFER_TOO_SMALL) {
-    if (Status != EFI_INVALID_PARAMETER) {
-      Status = EFI_NOT_FOUND;
+  if (SearchType == ByProtocol && Protocol != NULL) {
+    CoreAcquireProtocolLock ();
+    ProtEntry = CoreFindProtocolEntry (Protocol, FALSE);
+    if (ProtEntry != NULL) {
+      BufferSize = ProtEntry->InterfaceCount * sizeof (EFI_HANDLE);
+      DEBUG_CODE_BEGIN ();
+        if (BufferSize != 0) {
+          gProtocolDatabaseStatistics.LocateBufferSinglePassCount++;
+        }
+      DEBUG_CODE_END ();
     }
-    return Status;
+    CoreReleaseProtocolLock ();
   }
 
-  *Buffer = AllocatePool (BufferSize);
-  if (*Buffer == NULL) {
-    return EFI_OUT_OF_RESOURCES;
+  if (BufferSize == 0) {
+    Status = CoreLocateHandle (
+               SearchType,
+               Protocol,
+               SearchKey,
+               &BufferSize,
+               *Buffer
+               );
+    //
+    // LocateHandleBuffer() returns incorrect status code if SearchType is
+    // invalid.
+    //
+    // Add code to correctly handle expected errors from CoreLocateHandle().
+    //
+    if (EFI_ERROR(Status) && Status != EFI_BUFFER_TOO_SMALL) {
+      if (Status != EFI_INVALID_PARAMETER) {
+        Status = EFI_NOT_FOUND;
+      }
+      return Status;
+    }
   }
 
-  Status = CoreLocateHandle (
-             SearchType,
-             Protocol,
-             SearchKey,
-             &BufferSize,
-             *Buffer
-             );
+  do {
+    *Buffer = AllocatePool (BufferSize);
+    if (*Buffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Status = CoreLocateHandle (
+               SearchType,
+               Protocol,
+               SearchKey,
+               &BufferSize,
+               *Buffer
+               );
+
+    //
+    // Handles may have been added since the size was taken, retry with the
+    // size returned
+    //
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      CoreFreePool (*Buffer);
+      *Buffer = NULL;
+    }
+  } while (Status == EFI_BUFFER_TOO_SMALL);
 
   *NumberHandles = BufferSize / sizeof(EFI_HANDLE);
   if (EFI_ERROR(Status)) {
@@ -85,6 +85,7 @@ CoreRemoveInterfaceFromProtocol (
     // Remove the protocol interface entry
     //
     RemoveEntryList (&Prot->ByProtocol);
+    ProtEntry->InterfaceCount--;
   }
 
   return Prot;
@@ -255,6 +256,7 @@ CoreReinstallProtocolInterface (
   // protocol entry
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
+  ProtEntry->InterfaceCount++;
 
   //
   // Update the Key to show that the handle has been created/modified
@@ -103,4 +103,240 @@ CoreReleaseLock (
 }
 
 
+//
+// Tree Stuff
+//
+
+/**
+  Rotates a tree node above its parent, keeping the in-order walk of the tree
+  unchanged.
+
+  @param  Tree               The tree the node belongs to.
+  @param  Node               The node to rotate. It must have a parent.
+
+**/
+STATIC
+VOID
+CoreRotateTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node
+  )
+{
+  CORE_TREE_NODE  *Parent;
+  CORE_TREE_NODE  *GrandParent;
+
+  Parent      = Node->Parent;
+  GrandParent = Parent->Parent;
+
+  if (Parent->Left == Node) {
+    Parent->Left = Node->Right;
+    if (Node->Right != NULL) {
+      Node->Right->Parent = Parent;
+    }
+    Node->Right = Parent;
+  } else {
+    Parent->Right = Node->Left;
+    if (Node->Left != NULL) {
+      Node->Left->Parent = Parent;
+    }
+    Node->Left = Parent;
+  }
+  Parent->Parent = Node;
+
+  Node->Parent = GrandParent;
+  if (GrandParent == NULL) {
+    Tree->Root = Node;
+  } else if (GrandParent->Left == Parent) {
+    GrandParent->Left = Node;
+  } else {
+    GrandParent->Right = Node;
+  }
+
+  //
+  // Parent is now the child of Node
+  //
+  if (Tree->Update != NULL) {
+    Tree->Update (Parent);
+    Tree->Update (Node);
+  }
+}
+
+
+/**
+  Recomputes the subtree data of a node and of all its ancestors, after the
+  structure the node is embedded in has changed without changing its order.
+
+  @param  Tree               The tree.
+  @param  Node               The node whose structure changed.
+
+**/
+VOID
+CoreUpdateTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node
+  )
+{
+  if (Tree->Update == NULL) {
+    return;
+  }
+
+  for (; Node != NULL; Node = Node->Parent) {
+    Tree->Update (Node);
+  }
+}
+
+
+/**
+  Inserts a node in a tree, next to the node it follows or precedes in the
+  order of the indexed structures.
+
+  @param  Tree               The tree.
+  @param  Node               The node to insert.
+  @param  Neighbor           The node next to Node, or NULL if the tree is
+                             empty.
+  @param  After              TRUE if Node follows Neighbor, FALSE if it
+                             precedes it.
+
+**/
+VOID
+CoreInsertTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node,
+  IN CORE_TREE_NODE  *Neighbor,
+  IN BOOLEAN         After
+  )
+{
+  CORE_TREE_NODE  *Parent;
 
+  //
+  // Draw the priority of the node from a xorshift sequence
+  //
+  Tree->Seed ^= Tree->Seed << 13;
+  Tree->Seed ^= Tree->Seed >> 17;
+  Tree->Seed ^= Tree->Seed << 5;
+
+  Node->Left     = NULL;
+  Node->Right    = NULL;
+  Node->Priority = Tree->Seed;
+  Tree->Count++;
+
+  if (Neighbor == NULL) {
+    ASSERT (Tree->Root == NULL);
+    Node->Parent = NULL;
+    Tree->Root   = Node;
+    CoreUpdateTreeNode (Tree, Node);
+    return;
+  }
+
+  //
+  // Link the node as the in-order successor or predecessor of the neighbor
+  //
+  Parent = Neighbor;
+  if (After) {
+    if (Parent->Right == NULL) {
+      Parent->Right = Node;
+    } else {
+      Parent = Parent->Right;
+      while (Parent->Left != NULL) {
+        Parent = Parent->Left;
+      }
+      Parent->Left = Node;
+    }
+  } else {
+    if (Parent->Left == NULL) {
+      Parent->Left = Node;
+    } else {
+      Parent = Parent->Left;
+      while (Parent->Right != NULL) {
+        Parent = Parent->Right;
+      }
+      Parent->Right = Node;
+    }
+  }
+  Node->Parent = Parent;
+  CoreUpdateTreeNode (Tree, Node);
+
+  //
+  // Restore the heap order of the priorities
+  //
+  while (Node->Parent != NULL && Node->Parent->Priority > Node->Priority) {
+    CoreRotateTreeNode (Tree, Node);
+  }
+}
+
+
+/**
+  Removes a node from a tree.
+
+  @param  Tree               The tree.
+  @param  Node               The node to remove.
+
+**/
+VOID
+CoreRemoveTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node
+  )
+{
+  CORE_TREE_NODE  *Child;
+
+  ASSERT (Tree->Count != 0);
+  Tree->Count--;
+
+  //
+  // Rotate the node down until it has at most one child, then splice it out
+  //
+  while (Node->Left != NULL && Node->Right != NULL) {
+    if (Node->Left->Priority < Node->Right->Priority) {
+      CoreRotateTreeNode (Tree, Node->Left);
+    } else {
+      CoreRotateTreeNode (Tree, Node->Right);
+    }
+  }
+
+  Child = (Node->Left != NULL) ? Node->Left : Node->Right;
+  if (Child != NULL) {
+    Child->Parent = Node->Parent;
+  }
+  if (Node->Parent == NULL) {
+    Tree->Root = Child;
+  } else if (Node->Parent->Left == Node) {
+    Node->Parent->Left = Child;
+  } else {
+    Node->Parent->Right = Child;
+  }
+
+  CoreUpdateTreeNode (Tree, Node->Parent);
+}
+
+
+/**
+  Makes a copy of a node take the place of the node in a tree.
+
+  @param  Tree               The tree.
+  @param  Node               The node in the tree.
+  @param  NewNode            The copy of Node to link in its place.
+
+**/
+VOID
+CoreReplaceTreeNode (
+  IN CORE_TREE       *Tree,
+  IN CORE_TREE_NODE  *Node,
+  IN CORE_TREE_NODE  *NewNode
+  )
+{
+  if (NewNode->Left != NULL) {
+    NewNode->Left->Parent = NewNode;
+  }
+  if (NewNode->Right != NULL) {
+    NewNode->Right->Parent = NewNode;
+  }
+
+  if (NewNode->Parent == NULL) {
+    Tree->Root = NewNode;
+  } else if (NewNode->Parent->Left == Node) {
+    NewNode->Parent->Left = NewNode;
+  } else {
+    NewNode->Parent->Right = NewNode;
+  }
+}
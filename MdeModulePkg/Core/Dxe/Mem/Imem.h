@@ -39,6 +39,13 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 typedef struct {
   UINTN           Signature;
   LIST_ENTRY      Link;
+  //
+  // Node in the tree of the EfiConventionalMemory descriptors, and the length
+  // of the largest descriptor in its subtree. Only valid for
+  // EfiConventionalMemory.
+  //
+  CORE_TREE_NODE  TreeNode;
+  UINT64          MaxLength;
   BOOLEAN         FromPages;
 
   EFI_MEMORY_TYPE Type;
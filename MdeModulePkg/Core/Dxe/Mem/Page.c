@@ -127,6 +127,80 @@ CoreReleaseMemoryLock (
 
 
 
+/**
+  Internal function.  Recomputes the length of the largest descriptor in the
+  subtree of a node of mConventionalMemoryMapTree.
+
+  @param  Node                   The node to update
+
+**/
+STATIC
+VOID
+UpdateConventionalMemoryMapNode (
+  IN CORE_TREE_NODE      *Node
+  )
+{
+  MEMORY_MAP        *Entry;
+  MEMORY_MAP        *Child;
+
+  Entry = CR (Node, MEMORY_MAP, TreeNode, MEMORY_MAP_SIGNATURE);
+  Entry->MaxLength = Entry->End - Entry->Start + 1;
+
+  if (Node->Left != NULL) {
+    Child = CR (Node->Left, MEMORY_MAP, TreeNode, MEMORY_MAP_SIGNATURE);
+    if (Child->MaxLength > Entry->MaxLength) {
+      Entry->MaxLength = Child->MaxLength;
+    }
+  }
+
+  if (Node->Right != NULL) {
+    Child = CR (Node->Right, MEMORY_MAP, TreeNode, MEMORY_MAP_SIGNATURE);
+    if (Child->MaxLength > Entry->MaxLength) {
+      Entry->MaxLength = Child->MaxLength;
+    }
+  }
+}
+
+//
+// ConventionalMemoryMapTree - the EfiConventionalMemory descriptors of the
+// memory map, indexed by address and by the largest free length below each
+// node
+//
+CORE_TREE     mConventionalMemoryMapTree = { NULL, 0, 0x2545F491, UpdateConventionalMemoryMapNode };
+
+/**
+  Internal function.  Finds the free descriptor entry covering an address.
+
+  @param  Address                The address to look up
+
+  @return The EfiConventionalMemory entry covering Address, or NULL if the
+          address is not free.
+
+**/
+STATIC
+MEMORY_MAP *
+FindConventionalMemoryMapEntry (
+  IN EFI_PHYSICAL_ADDRESS  Address
+  )
+{
+  CORE_TREE_NODE    *Node;
+  MEMORY_MAP        *Entry;
+
+  Node = mConventionalMemoryMapTree.Root;
+  while (Node != NULL) {
+    Entry = CR (Node, MEMORY_MAP, TreeNode, MEMORY_MAP_SIGNATURE);
+    if (Address < Entry->Start) {
+      Node = Node->Left;
+    } else if (Address > Entry->End) {
+      Node = Node->Right;
+    } else {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   Internal function.  Removes a descriptor entry.
 
@@ -141,6 +215,10 @@ RemoveMemoryMapEntry (
   RemoveEntryList (&Entry->Link);
   Entry->Link.ForwardLink = NULL;
 
+  if (Entry->Type == EfiConventionalMemory) {
+    CoreRemoveTreeNode (&mConventionalMemoryMapTree, &Entry->TreeNode);
+  }
+
   if (Entry->FromPages) {
     //
     // Insert the free memory map descriptor to the end of mFreeMemoryMapEntryList
@@ -149,6 +227,39 @@ RemoveMemoryMapEntry (
   }
 }
 
+/**
+  Internal function.  Inserts a free descriptor entry into
+  mConventionalMemoryMapTree.
+
+  @param  Entry                  The EfiConventionalMemory entry to insert
+
+**/
+STATIC
+VOID
+InsertConventionalMemoryMapEntry (
+  IN OUT MEMORY_MAP      *Entry
+  )
+{
+  CORE_TREE_NODE    *Node;
+  CORE_TREE_NODE    *Parent;
+  MEMORY_MAP        *Entry2;
+  BOOLEAN           After;
+
+  ASSERT (Entry->Type == EfiConventionalMemory);
+
+  Parent = NULL;
+  After  = FALSE;
+  Node   = mConventionalMemoryMapTree.Root;
+  while (Node != NULL) {
+    Parent = Node;
+    Entry2 = CR (Node, MEMORY_MAP, TreeNode, MEMORY_MAP_SIGNATURE);
+    After  = (BOOLEAN) (Entry->Start > Entry2->Start);
+    Node   = After ? Node->Right : Node->Left;
+  }
+
+  CoreInsertTreeNode (&mConventionalMemoryMapTree, &Entry->TreeNode, Parent, After);
+}
+
 /**
   Internal function.  Adds a ranges to the memory map.
   The range must not already exist in the map.
@@ -218,28 +329,52 @@ CoreAddRange (
   // and the same Attribute
   //
 
-  Link = gMemoryMap.ForwardLink;
-  while (Link != &gMemoryMap) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    Link  = Link->ForwardLink;
-
-    if (Entry->Type != Type) {
-      continue;
+  if (Type == EfiConventionalMemory) {
+    //
+    // Only the free descriptors right below and right above the range can be
+    // merged with it
+    //
+    Entry = NULL;
+    if (Start > 0) {
+      Entry = FindConventionalMemoryMapEntry (Start - 1);
+    }
+    if (Entry != NULL && Entry->Attribute == Attribute && Entry->End + 1 == Start) {
+      Start = Entry->Start;
+      RemoveMemoryMapEntry (Entry);
     }
 
-    if (Entry->Attribute != Attribute) {
-      continue;
+    Entry = NULL;
+    if (End < MAX_UINT64) {
+      Entry = FindConventionalMemoryMapEntry (End + 1);
+    }
+    if (Entry != NULL && Entry->Attribute == Attribute && Entry->Start == End + 1) {
+      End = Entry->End;
+      RemoveMemoryMapEntry (Entry);
     }
+  } else {
+    Link = gMemoryMap.ForwardLink;
+    while (Link != &gMemoryMap) {
+      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+      Link  = Link->ForwardLink;
 
-    if (Entry->End + 1 == Start) {
+      if (Entry->Type != Type) {
+        continue;
+      }
 
-      Start = Entry->Start;
-      RemoveMemoryMapEntry (Entry);
+      if (Entry->Attribute != Attribute) {
+        continue;
+      }
 
-    } else if (Entry->Start == End + 1) {
+      if (Entry->End + 1 == Start) {
 
-      End = Entry->End;
-      RemoveMemoryMapEntry (Entry);
+        Start = Entry->Start;
+        RemoveMemoryMapEntry (Entry);
+
+      } else if (Entry->Start == End + 1) {
+
+        End = Entry->End;
+        RemoveMemoryMapEntry (Entry);
+      }
     }
   }
 
@@ -255,6 +390,9 @@ CoreAddRange (
   mMapStack[mMapDepth].VirtualStart  = 0;
   mMapStack[mMapDepth].Attribute     = Attribute;
   InsertTailList (&gMemoryMap, &mMapStack[mMapDepth].Link);
+  if (Type == EfiConventionalMemory) {
+    InsertConventionalMemoryMapEntry (&mMapStack[mMapDepth]);
+  }
 
   mMapDepth += 1;
   ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -368,6 +506,13 @@ CoreFreeMemoryMapStack (
       CopyMem (Entry , &mMapStack[mMapDepth], sizeof (MEMORY_MAP));
       Entry->FromPages = TRUE;
 
+      //
+      // Take over the place of the stack entry in the free descriptor tree
+      //
+      if (Entry->Type == EfiConventionalMemory) {
+        CoreReplaceTreeNode (&mConventionalMemoryMapTree, &mMapStack[mMapDepth].TreeNode, &Entry->TreeNode);
+      }
+
       //
       // Find insertion location
       //
@@ -766,13 +911,24 @@ CoreConvertPagesEx (
   while (Start < End) {
 
     //
-    // Find the entry that the covers the range
+    // Find the entry that the covers the range. Pages being allocated must be
+    // free, so look in the free descriptors first.
     //
-    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+    Link = &gMemoryMap;
+    if (ChangingType && (NewType != EfiConventionalMemory)) {
+      Entry = FindConventionalMemoryMapEntry (Start);
+      if (Entry != NULL) {
+        Link = &Entry->Link;
+      }
+    }
 
-      if (Entry->Start <= Start && Entry->End > Start) {
-        break;
+    if (Link == &gMemoryMap) {
+      for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
+        Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+
+        if (Entry->Start <= Start && Entry->End > Start) {
+          break;
+        }
       }
     }
 
@@ -858,6 +1014,9 @@ CoreConvertPagesEx (
       // Clip start
       //
       Entry->Start = RangeEnd + 1;
+      if (Entry->Type == EfiConventionalMemory) {
+        CoreUpdateTreeNode (&mConventionalMemoryMapTree, &Entry->TreeNode);
+      }
 
     } else if (Entry->End == RangeEnd) {
 
@@ -865,6 +1024,9 @@ CoreConvertPagesEx (
       // Clip end
       //
       Entry->End = Start - 1;
+      if (Entry->Type == EfiConventionalMemory) {
+        CoreUpdateTreeNode (&mConventionalMemoryMapTree, &Entry->TreeNode);
+      }
 
     } else {
 
@@ -889,6 +1051,14 @@ CoreConvertPagesEx (
       Entry->End = Start - 1;
       ASSERT (Entry->Start < Entry->End);
 
+      //
+      // The upper part follows the clipped entry in the free descriptor tree
+      //
+      if (Entry->Type == EfiConventionalMemory) {
+        CoreUpdateTreeNode (&mConventionalMemoryMapTree, &Entry->TreeNode);
+        CoreInsertTreeNode (&mConventionalMemoryMapTree, &mMapStack[mMapDepth].TreeNode, &Entry->TreeNode, TRUE);
+      }
+
       Entry = &mMapStack[mMapDepth];
       InsertTailList (&gMemoryMap, &Entry->Link);
 
@@ -1014,6 +1184,118 @@ CoreUpdateMemoryAttributes (
 }
 
 
+/**
+  Internal function.  Finds the highest free descriptor in a subtree of
+  mConventionalMemoryMapTree that can hold a range below the requested
+  address.
+
+  @param  Node                   The root of the subtree
+  @param  MaxAddress             The end of a page the range must be below
+  @param  MinAddress             The address that the range must be above
+  @param  NumberOfBytes          Number of bytes needed
+  @param  Alignment              Bits to align with
+  @param  NeedGuard              Flag to indicate Guard page is needed or not
+
+  @return The last address of the range, or 0 if the range was not found
+
+**/
+STATIC
+UINT64
+FindFreePagesInTree (
+  IN CORE_TREE_NODE   *Node,
+  IN UINT64           MaxAddress,
+  IN UINT64           MinAddress,
+  IN UINT64           NumberOfBytes,
+  IN UINTN            Alignment,
+  IN BOOLEAN          NeedGuard
+  )
+{
+  MEMORY_MAP      *Entry;
+  UINT64          Target;
+  UINT64          DescStart;
+  UINT64          DescEnd;
+  UINT64          DescNumberOfBytes;
+
+  while (Node != NULL) {
+    Entry = CR (Node, MEMORY_MAP, TreeNode, MEMORY_MAP_SIGNATURE);
+    ASSERT (Entry->Type == EfiConventionalMemory);
+
+    //
+    // If no desc in the subtree is large enough, skip them all
+    //
+    if (Entry->MaxLength < NumberOfBytes) {
+      return 0;
+    }
+
+    //
+    // If desc is past max allowed address, so are the higher ones. Otherwise
+    // try the higher ones first.
+    //
+    if (Entry->Start < MaxAddress) {
+      Target = FindFreePagesInTree (Node->Right, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard);
+      if (Target != 0) {
+        return Target;
+      }
+
+      //
+      // If desc is below min allowed address, so are the lower ones
+      //
+      if (Entry->End < MinAddress) {
+        return 0;
+      }
+
+      DescStart = Entry->Start;
+      DescEnd = Entry->End;
+
+      //
+      // If desc ends past max allowed address, clip the end
+      //
+      if (DescEnd >= MaxAddress) {
+        DescEnd = MaxAddress;
+      }
+
+      DescEnd = ((DescEnd + 1) & (~(Alignment - 1))) - 1;
+
+      //
+      // Compute the number of bytes we can used from this descriptor, and see
+      // it's enough to satisfy the request. Skip if DescEnd is less than
+      // DescStart after alignment clipping, or if the start of the allocated
+      // range is below the min address allowed.
+      //
+      if (DescEnd >= DescStart) {
+        DescNumberOfBytes = DescEnd - DescStart + 1;
+
+        if (DescNumberOfBytes >= NumberOfBytes &&
+            (DescEnd - NumberOfBytes + 1) >= MinAddress) {
+          if (NeedGuard) {
+            DescEnd = AdjustMemoryS (
+                        DescEnd + 1 - DescNumberOfBytes,
+                        DescNumberOfBytes,
+                        NumberOfBytes
+                        );
+          }
+
+          if (DescEnd != 0) {
+            return DescEnd;
+          }
+        }
+      }
+
+      //
+      // The lower descs all end below the start of this one
+      //
+      if (Entry->Start <= MinAddress) {
+        return 0;
+      }
+    }
+
+    Node = Node->Left;
+  }
+
+  return 0;
+}
+
+
 /**
   Internal function. Finds a consecutive free page range below
   the requested address.
@@ -1041,11 +1323,6 @@ CoreFindFreePagesI (
 {
   UINT64          NumberOfBytes;
   UINT64          Target;
-  UINT64          DescStart;
-  UINT64          DescEnd;
-  UINT64          DescNumberOfBytes;
-  LIST_ENTRY      *Link;
-  MEMORY_MAP      *Entry;
 
   if ((MaxAddress < EFI_PAGE_MASK) ||(NumberOfPages == 0)) {
     return 0;
@@ -1074,75 +1351,19 @@ CoreFindFreePagesI (
   }
 
   NumberOfBytes = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
-  Target = 0;
-
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-    //
-    // If it's not a free entry, don't bother with it
-    //
-    if (Entry->Type != EfiConventionalMemory) {
-      continue;
-    }
-
-    DescStart = Entry->Start;
-    DescEnd = Entry->End;
-
-    //
-    // If desc is past max allowed address or below min allowed address, skip it
-    //
-    if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
-      continue;
-    }
-
-    //
-    // If desc ends past max allowed address, clip the end
-    //
-    if (DescEnd >= MaxAddress) {
-      DescEnd = MaxAddress;
-    }
 
-    DescEnd = ((DescEnd + 1) & (~(Alignment - 1))) - 1;
-
-    // Skip if DescEnd is less than DescStart after alignment clipping
-    if (DescEnd < DescStart) {
-      continue;
-    }
-
-    //
-    // Compute the number of bytes we can used from this
-    // descriptor, and see it's enough to satisfy the request
-    //
-    DescNumberOfBytes = DescEnd - DescStart + 1;
-
-    if (DescNumberOfBytes >= NumberOfBytes) {
-      //
-      // If the start of the allocated range is below the min address allowed, skip it
-      //
-      if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
-        continue;
-      }
-
-      //
-      // If this is the best match so far remember it
-      //
-      if (DescEnd > Target) {
-        if (NeedGuard) {
-          DescEnd = AdjustMemoryS (
-                      DescEnd + 1 - DescNumberOfBytes,
-                      DescNumberOfBytes,
-                      NumberOfBytes
-                      );
-          if (DescEnd == 0) {
-            continue;
-          }
-        }
-
-        Target = DescEnd;
-      }
-    }
-  }
+  //
+  // The tree is searched from the highest free descriptor down, so the first
+  // one that can hold the range is the highest match.
+  //
+  Target = FindFreePagesInTree (
+             mConventionalMemoryMapTree.Root,
+             MaxAddress,
+             MinAddress,
+             NumberOfBytes,
+             Alignment,
+             NeedGuard
+             );
 
   //
   // If this is a grow down, adjust target to be the allocation base
@@ -66,6 +66,26 @@ STATIC CONST UINT16 mPoolSizeTable[] = {
 
 #define MAX_POOL_SIZE     (MAX_ADDRESS - POOL_OVERHEAD)
 
+//
+// Slab header placed at the start of each naturally aligned slab when
+// PcdPoolSlabAllocatorEnable is TRUE. A slab holds equally sized blocks of a
+// single size class, and the bitmap tracks which of them are in use so that
+// an empty slab can be handed back to the page allocator right away.
+//
+#define POOL_SLAB_SIGNATURE     SIGNATURE_32('p','s','l','b')
+#define POOL_SLAB_BITMAP_WORDS  8
+#define POOL_SLAB_MIN_BLOCKS    4
+typedef struct {
+  UINT32          Signature;
+  UINT32          Index;
+  LIST_ENTRY      Link;
+  UINT32          BlockCount;
+  UINT32          UsedCount;
+  UINT64          Bitmap[POOL_SLAB_BITMAP_WORDS];
+} POOL_SLAB;
+
+#define SIZE_OF_POOL_SLAB ALIGN_VALUE (sizeof (POOL_SLAB), 16)
+
 //
 // Globals
 //
@@ -76,6 +96,7 @@ typedef struct {
     UINTN            Used;
     EFI_MEMORY_TYPE  MemoryType;
     LIST_ENTRY       FreeList[MAX_POOL_LIST];
+    LIST_ENTRY       SlabList[MAX_POOL_LIST];
     LIST_ENTRY       Link;
 } POOL;
 
@@ -131,6 +152,7 @@ CoreInitializePool (
     mPoolHead[Type].MemoryType = (EFI_MEMORY_TYPE) Type;
     for (Index=0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
+      InitializeListHead (&mPoolHead[Type].SlabList[Index]);
     }
   }
 }
@@ -181,6 +203,7 @@ LookupPoolHead (
     Pool->MemoryType = MemoryType;
     for (Index=0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&Pool->FreeList[Index]);
+      InitializeListHead (&Pool->SlabList[Index]);
     }
 
     InsertHeadList (&mPoolHeadList, &Pool->Link);
@@ -338,6 +361,104 @@ CoreAllocatePoolPagesI (
   return Buffer;
 }
 
+/**
+  Get the size of the slab serving the specified pool size class.
+
+  A slab is at least one allocation granule, and is doubled until it holds
+  POOL_SLAB_MIN_BLOCKS blocks so that the large size classes do not waste
+  most of each granule.
+
+  @param  Index                  The pool size table index.
+  @param  Granularity            The page allocation granularity of the pool.
+
+  @return The size in bytes of the slab, which is a power of two.
+
+**/
+STATIC
+UINTN
+GetPoolSlabSize (
+  IN UINTN    Index,
+  IN UINTN    Granularity
+  )
+{
+  UINTN   SlabSize;
+
+  SlabSize = Granularity;
+  while ((SlabSize - SIZE_OF_POOL_SLAB) / LIST_TO_SIZE (Index) < POOL_SLAB_MIN_BLOCKS) {
+    SlabSize <<= 1;
+  }
+
+  ASSERT ((SlabSize - SIZE_OF_POOL_SLAB) / LIST_TO_SIZE (Index) <=
+          POOL_SLAB_BITMAP_WORDS * 64);
+  return SlabSize;
+}
+
+/**
+  Internal function.  Allocate one block of the specified size class from the
+  slabs of the pool, getting a new slab from the page allocator if all slabs
+  of the class are full.
+
+  @param  Pool                   The pool head of the memory type.
+  @param  Index                  The pool size table index.
+  @param  Granularity            The page allocation granularity of the pool.
+
+  @return The allocated block, or NULL
+
+**/
+STATIC
+POOL_HEAD *
+CoreAllocatePoolSlabBlock (
+  IN POOL     *Pool,
+  IN UINTN    Index,
+  IN UINTN    Granularity
+  )
+{
+  POOL_SLAB   *Slab;
+  UINTN       SlabSize;
+  UINTN       Word;
+  UINTN       Block;
+
+  if (IsListEmpty (&Pool->SlabList[Index])) {
+    //
+    // Slabs are aligned on their size so that the slab header can be found
+    // from any block address when the block is freed.
+    //
+    SlabSize = GetPoolSlabSize (Index, Granularity);
+    Slab = CoreAllocatePoolPagesI (Pool->MemoryType, EFI_SIZE_TO_PAGES (SlabSize),
+                                   SlabSize, FALSE);
+    if (Slab == NULL) {
+      return NULL;
+    }
+
+    Slab->Signature  = POOL_SLAB_SIGNATURE;
+    Slab->Index      = (UINT32)Index;
+    Slab->BlockCount = (UINT32)((SlabSize - SIZE_OF_POOL_SLAB) / LIST_TO_SIZE (Index));
+    Slab->UsedCount  = 0;
+    ZeroMem (Slab->Bitmap, sizeof (Slab->Bitmap));
+    InsertHeadList (&Pool->SlabList[Index], &Slab->Link);
+  }
+
+  //
+  // Only slabs with at least one free block are kept on the list, and blocks
+  // are always taken from the lowest clear bit, so the search cannot run past
+  // BlockCount.
+  //
+  Slab = CR (Pool->SlabList[Index].ForwardLink, POOL_SLAB, Link, POOL_SLAB_SIGNATURE);
+  for (Word = 0; Slab->Bitmap[Word] == MAX_UINT64; Word++) {
+    ASSERT (Word < POOL_SLAB_BITMAP_WORDS - 1);
+  }
+  Block = Word * 64 + (UINTN)LowBitSet64 (~Slab->Bitmap[Word]);
+  ASSERT (Block < Slab->BlockCount);
+
+  Slab->Bitmap[Word] |= LShiftU64 (1, Block % 64);
+  Slab->UsedCount++;
+  if (Slab->UsedCount == Slab->BlockCount) {
+    RemoveEntryList (&Slab->Link);
+  }
+
+  return (POOL_HEAD *)((UINT8 *)Slab + SIZE_OF_POOL_SLAB + Block * LIST_TO_SIZE (Index));
+}
+
 /**
   Internal function to allocate pool of a particular type.
   Caller must have the memory lock held
@@ -422,6 +543,14 @@ CoreAllocatePoolI (
     goto Done;
   }
 
+  //
+  // Serve the request from the slabs of the size class if enabled
+  //
+  if (FeaturePcdGet (PcdPoolSlabAllocatorEnable)) {
+    Head = CoreAllocatePoolSlabBlock (Pool, Index, Granularity);
+    goto Done;
+  }
+
   //
   // If there's no free pool in the proper list size, go get some more pages
   //
@@ -659,6 +788,110 @@ CoreFreePoolPagesWithGuard (
   }
 }
 
+/**
+  Internal function.  Check that a pool block is an allocated block of a slab.
+
+  @param  Head                   The pool block to check.
+  @param  Index                  The pool size table index.
+  @param  Granularity            The page allocation granularity of the pool.
+  @param  Slab                   Returns the slab holding the block.
+  @param  Block                  Returns the index of the block in the slab.
+
+  @retval EFI_INVALID_PARAMETER  Head is not an allocated block of a slab.
+  @retval EFI_SUCCESS            Head is an allocated block of Slab.
+
+**/
+STATIC
+EFI_STATUS
+CoreGetPoolSlabBlock (
+  IN  POOL_HEAD  *Head,
+  IN  UINTN      Index,
+  IN  UINTN      Granularity,
+  OUT POOL_SLAB  **Slab,
+  OUT UINTN      *Block
+  )
+{
+  UINTN       SlabSize;
+  UINT64      Mask;
+
+  SlabSize = GetPoolSlabSize (Index, Granularity);
+  *Slab = (POOL_SLAB *)((UINTN)Head & ~(SlabSize - 1));
+  if ((*Slab)->Signature != POOL_SLAB_SIGNATURE || (*Slab)->Index != Index) {
+    ASSERT ((*Slab)->Signature == POOL_SLAB_SIGNATURE && (*Slab)->Index == Index);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *Block = ((UINTN)Head - (UINTN)*Slab - SIZE_OF_POOL_SLAB) / LIST_TO_SIZE (Index);
+  Mask   = LShiftU64 (1, *Block % 64);
+  if (*Block >= (*Slab)->BlockCount || ((*Slab)->Bitmap[*Block / 64] & Mask) == 0) {
+    ASSERT (*Block < (*Slab)->BlockCount && ((*Slab)->Bitmap[*Block / 64] & Mask) != 0);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Internal function.  Return a block to its slab, and give the slab back to
+  the page allocator once none of its blocks is in use.
+
+  @param  Pool                   The pool head of the memory type.
+  @param  Head                   The pool block to free.
+  @param  Index                  The pool size table index.
+  @param  Granularity            The page allocation granularity of the pool.
+
+  @retval EFI_INVALID_PARAMETER  Head is not an allocated block of a slab.
+  @retval EFI_SUCCESS            The block was freed.
+
+**/
+STATIC
+EFI_STATUS
+CoreFreePoolSlabBlock (
+  IN POOL       *Pool,
+  IN POOL_HEAD  *Head,
+  IN UINTN      Index,
+  IN UINTN      Granularity
+  )
+{
+  EFI_STATUS  Status;
+  POOL_SLAB   *Slab;
+  UINTN       SlabSize;
+  UINTN       Block;
+  UINT64      Mask;
+
+  Status = CoreGetPoolSlabBlock (Head, Index, Granularity, &Slab, &Block);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  SlabSize = GetPoolSlabSize (Index, Granularity);
+  Mask     = LShiftU64 (1, Block % 64);
+
+  //
+  // Invalidate the header so that a double free is caught by the signature
+  // check in CoreFreePoolI().
+  //
+  Head->Signature = POOL_FREE_SIGNATURE;
+  Slab->Bitmap[Block / 64] &= ~Mask;
+
+  //
+  // A full slab is off the list; it has a free block again now
+  //
+  if (Slab->UsedCount == Slab->BlockCount) {
+    InsertHeadList (&Pool->SlabList[Index], &Slab->Link);
+  }
+
+  Slab->UsedCount--;
+  if (Slab->UsedCount == 0) {
+    RemoveEntryList (&Slab->Link);
+    Slab->Signature = 0;
+    CoreFreePoolPagesI (Pool->MemoryType, (EFI_PHYSICAL_ADDRESS)(UINTN)Slab,
+      EFI_SIZE_TO_PAGES (SlabSize));
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Internal function to free a pool entry.
   Caller must have the memory lock held
@@ -676,6 +909,7 @@ CoreFreePoolI (
   OUT EFI_MEMORY_TYPE   *PoolType OPTIONAL
   )
 {
+  EFI_STATUS  Status;
   POOL        *Pool;
   POOL_HEAD   *Head;
   POOL_TAIL   *Tail;
@@ -690,6 +924,9 @@ CoreFreePoolI (
   BOOLEAN     IsGuarded;
   BOOLEAN     HasPoolTail;
   BOOLEAN     PageAsPool;
+  BOOLEAN     SlabBlock;
+  POOL_SLAB   *Slab;
+  UINTN       Block;
 
   ASSERT(Buffer != NULL);
   //
@@ -740,8 +977,6 @@ CoreFreePoolI (
   if (Pool == NULL) {
     return EFI_INVALID_PARAMETER;
   }
-  Pool->Used -= Size;
-  DEBUG ((DEBUG_POOL, "FreePool: %p (len %lx) %,ld\n", Head->Data, (UINT64)(Head->Size - POOL_OVERHEAD), (UINT64) Pool->Used));
 
   if  (Head->Type == EfiACPIReclaimMemory   ||
        Head->Type == EfiACPIMemoryNVS       ||
@@ -753,14 +988,31 @@ CoreFreePoolI (
     Granularity = DEFAULT_PAGE_ALLOCATION_GRANULARITY;
   }
 
-  if (PoolType != NULL) {
-    *PoolType = Head->Type;
-  }
-
   //
   // Determine the pool list
   //
   Index = SIZE_TO_LIST(Size);
+  SlabBlock = (BOOLEAN) (Index < SIZE_TO_LIST (Granularity) && !IsGuarded && !PageAsPool &&
+                         FeaturePcdGet (PcdPoolSlabAllocatorEnable));
+
+  //
+  // Reject a block that isn't allocated from a slab before anything is
+  // accounted or cleared for it
+  //
+  if (SlabBlock) {
+    Status = CoreGetPoolSlabBlock (Head, Index, Granularity, &Slab, &Block);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Pool->Used -= Size;
+  DEBUG ((DEBUG_POOL, "FreePool: %p (len %lx) %,ld\n", Head->Data, (UINT64)(Head->Size - POOL_OVERHEAD), (UINT64) Pool->Used));
+
+  if (PoolType != NULL) {
+    *PoolType = Head->Type;
+  }
+
   DEBUG_CLEAR_MEMORY (Head, Size);
 
   //
@@ -788,6 +1040,14 @@ CoreFreePoolI (
         );
     }
 
+  } else if (SlabBlock) {
+
+    //
+    // Return the block to its slab
+    //
+    Status = CoreFreePoolSlabBlock (Pool, Head, Index, Granularity);
+    ASSERT_EFI_ERROR (Status);
+
   } else {
 
     //
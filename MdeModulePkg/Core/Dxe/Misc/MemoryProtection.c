@@ -45,6 +45,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <Protocol/FirmwareVolume2.h>
 #include <Protocol/SimpleFileSystem.h>
+#include <Protocol/MemoryAttributeBatch.h>
 
 #include "DxeMain.h"
 #include "Mem/HeapGuard.h"
@@ -70,12 +71,27 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define PREVIOUS_MEMORY_DESCRIPTOR(MemoryDescriptor, Size) \
   ((EFI_MEMORY_DESCRIPTOR *)((UINT8 *)(MemoryDescriptor) - (Size)))
 
+//
+// Maximum number of pending memory attribute updates. The batch is committed
+// early once it is full.
+//
+#define MEMORY_ATTRIBUTE_BATCH_SIZE            64
+
 UINT32   mImageProtectionPolicy;
 
 extern LIST_ENTRY         mGcdMemorySpaceMap;
 
 STATIC LIST_ENTRY         mProtectedImageRecordList;
 
+//
+// Pending memory attribute updates, in the order they were requested.
+//
+STATIC EDKII_MEMORY_ATTRIBUTE_RANGE           mMemoryAttributeBatch[MEMORY_ATTRIBUTE_BATCH_SIZE];
+STATIC UINTN                                  mMemoryAttributeBatchCount;
+STATIC UINTN                                  mMemoryAttributeBatchDepth;
+STATIC BOOLEAN                                mMemoryAttributeBatchCommitting;
+STATIC EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL  *mMemoryAttributeBatchProtocol;
+
 /**
   Sort code section in image record, based upon CodeSegmentBase from low to high.
 
@@ -207,9 +223,137 @@ GetUefiImageProtectionPolicy (
 }
 
 
+/**
+  Apply all pending memory attribute updates.
+
+  The updates are handed to the Memory Attribute Batch Protocol in one call if
+  it is available, so the page table is walked and the TLB flushed only once.
+  Otherwise they are applied one by one through the CPU Arch Protocol.
+**/
+STATIC
+VOID
+CommitMemoryAttributeBatch (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+
+  if (mMemoryAttributeBatchCount == 0) {
+    return;
+  }
+
+  ASSERT (gCpu != NULL);
+  mMemoryAttributeBatchCommitting = TRUE;
+  Status = EFI_UNSUPPORTED;
+  if (mMemoryAttributeBatchProtocol != NULL) {
+    Status = mMemoryAttributeBatchProtocol->SetMemoryAttributesBatch (
+                                              mMemoryAttributeBatchProtocol,
+                                              mMemoryAttributeBatch,
+                                              mMemoryAttributeBatchCount
+                                              );
+  }
+
+  //
+  // EFI_INVALID_PARAMETER means the batch was rejected as a whole. Apply the
+  // ranges one by one so that the valid ones still take effect.
+  //
+  if ((mMemoryAttributeBatchProtocol == NULL) || (Status == EFI_INVALID_PARAMETER)) {
+    for (Index = 0; Index < mMemoryAttributeBatchCount; Index++) {
+      gCpu->SetMemoryAttributes (
+              gCpu,
+              mMemoryAttributeBatch[Index].BaseAddress,
+              mMemoryAttributeBatch[Index].Length,
+              mMemoryAttributeBatch[Index].Attributes
+              );
+    }
+  }
+
+  mMemoryAttributeBatchCount = 0;
+  mMemoryAttributeBatchCommitting = FALSE;
+}
+
+/**
+  Start collecting memory attribute updates. Updates queued until the matching
+  EndMemoryAttributeBatch() are committed together. Batches may be nested.
+**/
+STATIC
+VOID
+BeginMemoryAttributeBatch (
+  VOID
+  )
+{
+  mMemoryAttributeBatchDepth++;
+}
+
+/**
+  End a batch started by BeginMemoryAttributeBatch(). The pending updates are
+  committed when the outermost batch ends.
+**/
+STATIC
+VOID
+EndMemoryAttributeBatch (
+  VOID
+  )
+{
+  ASSERT (mMemoryAttributeBatchDepth > 0);
+  mMemoryAttributeBatchDepth--;
+  if (mMemoryAttributeBatchDepth == 0) {
+    CommitMemoryAttributeBatch ();
+  }
+}
+
+/**
+  Queue a memory attribute update.
+
+  If the range immediately follows the last queued range and has the same
+  attributes, the last range is extended instead of adding a new entry. Ranges
+  are otherwise kept in request order, so a later range still overrides an
+  earlier overlapping one.
+
+  @param[in]  BaseAddress            Specified start address
+  @param[in]  Length                 Specified length
+  @param[in]  Attributes             Final attributes, including cache attributes
+**/
+STATIC
+VOID
+QueueMemoryAttributes (
+  IN UINT64   BaseAddress,
+  IN UINT64   Length,
+  IN UINT64   Attributes
+  )
+{
+  EDKII_MEMORY_ATTRIBUTE_RANGE  *Last;
+
+  if (mMemoryAttributeBatchCount > 0) {
+    Last = &mMemoryAttributeBatch[mMemoryAttributeBatchCount - 1];
+    if ((Last->BaseAddress + Last->Length == BaseAddress) &&
+        (Last->Attributes == Attributes)) {
+      Last->Length += Length;
+      return;
+    }
+  }
+
+  if (mMemoryAttributeBatchCount == MEMORY_ATTRIBUTE_BATCH_SIZE) {
+    CommitMemoryAttributeBatch ();
+  }
+
+  mMemoryAttributeBatch[mMemoryAttributeBatchCount].BaseAddress = BaseAddress;
+  mMemoryAttributeBatch[mMemoryAttributeBatchCount].Length      = Length;
+  mMemoryAttributeBatch[mMemoryAttributeBatchCount].Attributes  = Attributes;
+  mMemoryAttributeBatchCount++;
+
+  if (mMemoryAttributeBatchDepth == 0) {
+    CommitMemoryAttributeBatch ();
+  }
+}
+
 /**
   Set UEFI image memory attributes.
 
+  The update is queued if a memory attribute batch is open, and applied
+  immediately otherwise.
+
   @param[in]  BaseAddress            Specified start address
   @param[in]  Length                 Specified length
   @param[in]  Attributes             Specified attributes
@@ -233,7 +377,7 @@ SetUefiImageMemoryAttributes (
   DEBUG ((DEBUG_INFO, "SetUefiImageMemoryAttributes - 0x%016lx - 0x%016lx (0x%016lx)\n", BaseAddress, Length, FinalAttributes));
 
   ASSERT(gCpu != NULL);
-  gCpu->SetMemoryAttributes (gCpu, BaseAddress, Length, FinalAttributes);
+  QueueMemoryAttributes (BaseAddress, Length, FinalAttributes);
 }
 
 /**
@@ -258,6 +402,11 @@ SetUefiImageProtectionAttributes (
   CurrentBase = ImageRecord->ImageBase;
   ImageEnd    = ImageRecord->ImageBase + ImageRecord->ImageSize;
 
+  //
+  // Apply the DATA and CODE ranges of the image together.
+  //
+  BeginMemoryAttributeBatch ();
+
   ImageRecordCodeSectionLink = ImageRecordCodeSectionList->ForwardLink;
   ImageRecordCodeSectionEndLink = ImageRecordCodeSectionList;
   while (ImageRecordCodeSectionLink != ImageRecordCodeSectionEndLink) {
@@ -304,6 +453,7 @@ SetUefiImageProtectionAttributes (
       EFI_MEMORY_XP
       );
   }
+  EndMemoryAttributeBatch ();
   return ;
 }
 
@@ -861,6 +1011,11 @@ InitializeDxeNxMemoryProtectionPolicy (
 
   MergeMemoryMapForProtectionPolicy (MemoryMap, &MemoryMapSize, DescriptorSize);
 
+  //
+  // Collect the updates for all regions and commit them together at the end.
+  //
+  BeginMemoryAttributeBatch ();
+
   MemoryMapEntry = MemoryMap;
   MemoryMapEnd = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) MemoryMap + MemoryMapSize);
   while ((UINTN) MemoryMapEntry < (UINTN) MemoryMapEnd) {
@@ -939,7 +1094,7 @@ InitializeDxeNxMemoryProtectionPolicy (
           Attributes));
 
         ASSERT(gCpu != NULL);
-        gCpu->SetMemoryAttributes (gCpu, Entry->BaseAddress,
+        QueueMemoryAttributes (Entry->BaseAddress,
           Entry->EndAddress - Entry->BaseAddress + 1, Attributes);
       }
 
@@ -947,6 +1102,8 @@ InitializeDxeNxMemoryProtectionPolicy (
     }
     CoreReleaseGcdMemoryLock ();
   }
+
+  EndMemoryAttributeBatch ();
 }
 
 
@@ -978,6 +1135,19 @@ MemoryProtectionCpuArchProtocolNotify (
     goto Done;
   }
 
+  //
+  // The batch protocol is optional. Without it, updates are applied one by
+  // one through the CPU Arch Protocol.
+  //
+  Status = CoreLocateProtocol (
+             &gEdkiiMemoryAttributeBatchProtocolGuid,
+             NULL,
+             (VOID **)&mMemoryAttributeBatchProtocol
+             );
+  if (EFI_ERROR (Status)) {
+    mMemoryAttributeBatchProtocol = NULL;
+  }
+
   //
   // Apply the memory protection policy on non-BScode/RTcode regions.
   //
@@ -1005,6 +1175,7 @@ MemoryProtectionCpuArchProtocolNotify (
     goto Done;
   }
 
+  BeginMemoryAttributeBatch ();
   for (Index = 0; Index < NoHandles; Index++) {
     Status = gBS->HandleProtocol (
                     HandleBuffer[Index],
@@ -1025,6 +1196,7 @@ MemoryProtectionCpuArchProtocolNotify (
 
     ProtectUefiImage (LoadedImage, LoadedImageDevicePath);
   }
+  EndMemoryAttributeBatch ();
   FreePool (HandleBuffer);
 
 Done:
@@ -1052,10 +1224,12 @@ MemoryProtectionExitBootServicesCallback (
   // OS may set protection on RT based upon EFI_MEMORY_ATTRIBUTES_TABLE later.
   //
   if (mImageProtectionPolicy != 0) {
+    BeginMemoryAttributeBatch ();
     for (Link = gRuntime->ImageHead.ForwardLink; Link != &gRuntime->ImageHead; Link = Link->ForwardLink) {
       RuntimeImage = BASE_CR (Link, EFI_RUNTIME_IMAGE_ENTRY, Link);
       SetUefiImageMemoryAttributes ((UINT64)(UINTN)RuntimeImage->ImageBase, ALIGN_VALUE(RuntimeImage->ImageSize, EFI_PAGE_SIZE), 0);
     }
+    EndMemoryAttributeBatch ();
   }
 }
 
@@ -1196,6 +1370,10 @@ IsInSmm (
   Manage memory permission attributes on a memory range, according to the
   configured DXE memory protection policy.
 
+  If a memory attribute batch is open, the update is queued behind the ranges
+  already in it, so that it cannot be overridden by an earlier update that is
+  committed later.
+
   @param  OldType           The old memory type of the range
   @param  NewType           The new memory type of the range
   @param  Memory            The base address of the range
@@ -1206,6 +1384,7 @@ IsInSmm (
   @return EFI_SUCCESS       If the the CPU arch protocol is not installed yet
   @return EFI_SUCCESS       If no DXE memory protection policy has been configured
   @return EFI_SUCCESS       If OldType and NewType use the same permission attributes
+  @return EFI_SUCCESS       If the update was queued in an open memory attribute batch
   @return other             Return value of gCpu->SetMemoryAttributes()
 
 **/
@@ -1285,5 +1464,14 @@ ApplyMemoryProtectionPolicy (
     return EFI_SUCCESS;
   }
 
+  //
+  // Page table pages allocated by the CPU driver while a batch is being
+  // committed must not be queued behind the batch that is in flight.
+  //
+  if ((mMemoryAttributeBatchDepth > 0) && !mMemoryAttributeBatchCommitting) {
+    QueueMemoryAttributes (Memory, Length, NewAttributes);
+    return EFI_SUCCESS;
+  }
+
   return gCpu->SetMemoryAttributes (gCpu, Memory, Length, NewAttributes);
 }
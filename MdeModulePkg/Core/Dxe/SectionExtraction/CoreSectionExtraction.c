@@ -749,7 +749,14 @@ CreateChildNode (
       //
       // Allocate space for the new stream
       //
-      if (UncompressedLength > 0) {
+      if ((UncompressedLength > 0) &&
+          (CompressionType == EFI_STANDARD_COMPRESSION) &&
+          CoreTakeDecodedSection (SectionHeader, Node->Size, &NewStreamBuffer, &NewStreamBufferSize, &AuthenticationStatus)) {
+        //
+        // The dispatcher already decompressed the stream on an AP.
+        //
+        ASSERT (NewStreamBufferSize == UncompressedLength);
+      } else if (UncompressedLength > 0) {
         NewStreamBufferSize = UncompressedLength;
         NewStreamBuffer = AllocatePool (NewStreamBufferSize);
         if (NewStreamBuffer == NULL) {
@@ -842,17 +849,26 @@ CreateChildNode (
         GuidedSectionAttributes = GuidedHeader->Attributes;
       }
       if (VerifyGuidedSectionGuid (Node->EncapsulationGuid, &GuidedExtraction)) {
-        //
-        // NewStreamBuffer is always allocated by ExtractSection... No caller
-        // allocation here.
-        //
-        Status = GuidedExtraction->ExtractSection (
-                                     GuidedExtraction,
-                                     GuidedHeader,
-                                     &NewStreamBuffer,
-                                     &NewStreamBufferSize,
-                                     &AuthenticationStatus
-                                     );
+        if ((GuidedExtraction == &mCustomGuidedSectionExtractionProtocol) &&
+            CoreTakeDecodedSection (GuidedHeader, Node->Size, &NewStreamBuffer, &NewStreamBufferSize, &AuthenticationStatus)) {
+          //
+          // The dispatcher already extracted the section on an AP, with the
+          // same handler the DXE core extraction protocol would have used.
+          //
+          Status = EFI_SUCCESS;
+        } else {
+          //
+          // NewStreamBuffer is always allocated by ExtractSection... No caller
+          // allocation here.
+          //
+          Status = GuidedExtraction->ExtractSection (
+                                       GuidedExtraction,
+                                       GuidedHeader,
+                                       &NewStreamBuffer,
+                                       &NewStreamBufferSize,
+                                       &AuthenticationStatus
+                                       );
+        }
         if (EFI_ERROR (Status)) {
           CoreFreePool (*ChildNode);
           return EFI_PROTOCOL_ERROR;
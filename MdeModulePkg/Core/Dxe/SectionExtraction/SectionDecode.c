@@ -0,0 +1,672 @@
+/** @file
+  Decode compressed sections of scheduled drivers ahead of time on the
+  application processors.
+
+  While draining the scheduled queue, the DXE Dispatcher hands the files at
+  the head of the queue to this module in batches of bounded size. The top
+  level sections of those files are walked and each one that is compressed
+  with the EFI standard compression algorithm, or GUIDed with one of the LZMA
+  or Brotli algorithms, becomes a decode job. All buffers are allocated on the
+  BSP, then the jobs are spread over the BSP and the APs through the MP
+  Services Protocol. Each processor takes a fixed share of the jobs, so no
+  lock is shared between processors. The decoders are pure functions of their
+  input and scratch buffers, so no boot service is ever called on an AP.
+
+  The decoded buffers are kept in a cache. When the section extraction code
+  later encounters the same encapsulation section, it adopts the decoded
+  buffer instead of decoding the section itself. A cache entry only matches a
+  section with identical contents, so a file is still read, verified and
+  loaded exactly as it would be without this module. Entries that were not
+  consumed are freed by the dispatcher before the next batch is decoded.
+
+Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "DxeMain.h"
+
+#define SECTION_DECODE_FILE_SIGNATURE  SIGNATURE_32('s','d','f','l')
+#define SECTION_DECODE_JOB_SIGNATURE   SIGNATURE_32('s','d','j','b')
+
+//
+// Once the file copies and the buffers of a batch reach this size, no more
+// file is added to it.
+//
+#define SECTION_DECODE_MAX_BATCH_SIZE  SIZE_16MB
+
+//
+// A copy of a scheduled file. The decode jobs point into its buffer.
+//
+typedef struct {
+  UINTN                       Signature;
+  LIST_ENTRY                  Link;
+  VOID                        *Buffer;
+} SECTION_DECODE_FILE;
+
+typedef struct {
+  UINTN                       Signature;
+  LIST_ENTRY                  Link;
+  //
+  // The encapsulation section, including its header.
+  //
+  UINT8                       Type;
+  CONST VOID                  *Section;
+  UINT32                      SectionSize;
+  //
+  // Compressed data of an EFI_SECTION_COMPRESSION section.
+  //
+  CONST VOID                  *Source;
+  //
+  // Buffers allocated by the BSP before the job runs.
+  //
+  VOID                        *OutputBuffer;
+  UINT32                      OutputSize;
+  VOID                        *ScratchBuffer;
+  //
+  // Results written by the processor that runs the job.
+  //
+  VOID                        *DecodedBuffer;
+  UINT32                      AuthenticationStatus;
+  RETURN_STATUS               Status;
+} SECTION_DECODE_JOB;
+
+typedef struct {
+  EFI_MP_SERVICES_PROTOCOL    *MpServices;
+  //
+  // The processor numbered N runs the jobs N, N + NumberOfProcessors, ...
+  //
+  UINTN                       NumberOfProcessors;
+  SECTION_DECODE_JOB          **Jobs;
+  UINTN                       JobCount;
+} SECTION_DECODE_CONTEXT;
+
+//
+// GUIDed sections whose decoders only touch the buffers they are given.
+//
+EFI_GUID  *mApSafeSectionGuids[] = {
+  &gLzmaCustomDecompressGuid,
+  &gLzmaF86CustomDecompressGuid,
+  &gBrotliCustomDecompressGuid
+};
+
+LIST_ENTRY  mSectionDecodeFileList = INITIALIZE_LIST_HEAD_VARIABLE (mSectionDecodeFileList);
+LIST_ENTRY  mSectionDecodeJobList  = INITIALIZE_LIST_HEAD_VARIABLE (mSectionDecodeJobList);
+UINTN       mSectionDecodeJobCount = 0;
+UINTN       mSectionDecodeBatchSize = 0;
+
+/**
+  Free a decode job and all the buffers it still owns.
+
+  @param  Job     The decode job to free.
+
+**/
+STATIC
+VOID
+CoreFreeSectionDecodeJob (
+  IN SECTION_DECODE_JOB  *Job
+  )
+{
+  if (Job->OutputBuffer != NULL) {
+    CoreFreePool (Job->OutputBuffer);
+  }
+  if (Job->ScratchBuffer != NULL) {
+    CoreFreePool (Job->ScratchBuffer);
+  }
+  CoreFreePool (Job);
+}
+
+/**
+  Check if a GUIDed section can be decoded on an AP.
+
+  @param  SectionGuid     The section definition GUID.
+
+  @retval TRUE    The section is decoded by a DXE core handler that is safe to run on an AP.
+  @retval FALSE   The section must be processed on the BSP.
+
+**/
+STATIC
+BOOLEAN
+IsApSafeGuidedSection (
+  IN CONST EFI_GUID  *SectionGuid
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mApSafeSectionGuids); Index++) {
+    if (CompareGuid (SectionGuid, mApSafeSectionGuids[Index])) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Create a decode job for an encapsulation section if it is worth decoding
+  ahead of time, and allocate the buffers the decoder needs.
+
+  @param  Section         The section header.
+  @param  SectionSize     The size of the section, including its header.
+
+  @retval EFI_SUCCESS           A decode job was queued.
+  @retval EFI_UNSUPPORTED       The section is not decoded ahead of time.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory to decode the section.
+
+**/
+STATIC
+EFI_STATUS
+CoreQueueSectionDecodeJob (
+  IN EFI_COMMON_SECTION_HEADER  *Section,
+  IN UINT32                     SectionSize
+  )
+{
+  RETURN_STATUS             Status;
+  SECTION_DECODE_JOB        *Job;
+  CONST VOID                *Source;
+  UINT32                    SourceSize;
+  UINT32                    UncompressedLength;
+  UINT8                     CompressionType;
+  EFI_GUID                  *SectionGuid;
+  UINT32                    OutputSize;
+  UINT32                    ScratchSize;
+  UINT16                    SectionAttribute;
+
+  Source = NULL;
+
+  if (Section->Type == EFI_SECTION_COMPRESSION) {
+    if (IS_SECTION2 (Section)) {
+      if (SectionSize < sizeof (EFI_COMPRESSION_SECTION2)) {
+        return EFI_UNSUPPORTED;
+      }
+      Source             = (UINT8 *) Section + sizeof (EFI_COMPRESSION_SECTION2);
+      SourceSize         = SectionSize - sizeof (EFI_COMPRESSION_SECTION2);
+      UncompressedLength = ((EFI_COMPRESSION_SECTION2 *) Section)->UncompressedLength;
+      CompressionType    = ((EFI_COMPRESSION_SECTION2 *) Section)->CompressionType;
+    } else {
+      if (SectionSize < sizeof (EFI_COMPRESSION_SECTION)) {
+        return EFI_UNSUPPORTED;
+      }
+      Source             = (UINT8 *) Section + sizeof (EFI_COMPRESSION_SECTION);
+      SourceSize         = SectionSize - sizeof (EFI_COMPRESSION_SECTION);
+      UncompressedLength = ((EFI_COMPRESSION_SECTION *) Section)->UncompressedLength;
+      CompressionType    = ((EFI_COMPRESSION_SECTION *) Section)->CompressionType;
+    }
+
+    if ((CompressionType != EFI_STANDARD_COMPRESSION) || (UncompressedLength == 0)) {
+      return EFI_UNSUPPORTED;
+    }
+
+    Status = UefiDecompressGetInfo (Source, SourceSize, &OutputSize, &ScratchSize);
+    if (RETURN_ERROR (Status) || (OutputSize != UncompressedLength)) {
+      return EFI_UNSUPPORTED;
+    }
+  } else if (Section->Type == EFI_SECTION_GUID_DEFINED) {
+    if (IS_SECTION2 (Section)) {
+      if (SectionSize < sizeof (EFI_GUID_DEFINED_SECTION2)) {
+        return EFI_UNSUPPORTED;
+      }
+      SectionGuid = &((EFI_GUID_DEFINED_SECTION2 *) Section)->SectionDefinitionGuid;
+    } else {
+      if (SectionSize < sizeof (EFI_GUID_DEFINED_SECTION)) {
+        return EFI_UNSUPPORTED;
+      }
+      SectionGuid = &((EFI_GUID_DEFINED_SECTION *) Section)->SectionDefinitionGuid;
+    }
+
+    if (!IsApSafeGuidedSection (SectionGuid)) {
+      return EFI_UNSUPPORTED;
+    }
+
+    //
+    // Fails if no handler for this GUID is linked into the DXE core.
+    //
+    Status = ExtractGuidedSectionGetInfo (Section, &OutputSize, &ScratchSize, &SectionAttribute);
+    if (RETURN_ERROR (Status) || (OutputSize == 0)) {
+      return EFI_UNSUPPORTED;
+    }
+  } else {
+    return EFI_UNSUPPORTED;
+  }
+
+  Job = AllocateZeroPool (sizeof (SECTION_DECODE_JOB));
+  if (Job == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Job->Signature    = SECTION_DECODE_JOB_SIGNATURE;
+  Job->Type         = Section->Type;
+  Job->Section      = Section;
+  Job->SectionSize  = SectionSize;
+  Job->Source       = Source;
+  Job->OutputSize   = OutputSize;
+  Job->Status       = RETURN_NOT_STARTED;
+
+  Job->OutputBuffer = AllocatePool (OutputSize);
+  if (ScratchSize > 0) {
+    Job->ScratchBuffer = AllocatePool (ScratchSize);
+  }
+  if ((Job->OutputBuffer == NULL) || ((ScratchSize > 0) && (Job->ScratchBuffer == NULL))) {
+    CoreFreeSectionDecodeJob (Job);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  InsertTailList (&mSectionDecodeJobList, &Job->Link);
+  mSectionDecodeJobCount++;
+  mSectionDecodeBatchSize += OutputSize + ScratchSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Read a file from a firmware volume and queue a decode job for each of its
+  top level encapsulation sections that can be decoded on an AP.
+
+  @param  Fv              The firmware volume the file lives in.
+  @param  FileName        The name of the file.
+
+  @retval EFI_SUCCESS           The file was read and its sections were examined.
+  @retval EFI_UNSUPPORTED       No file section can be decoded ahead of time.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory to read the file.
+  @retval Others                The file could not be read.
+
+**/
+STATIC
+EFI_STATUS
+CoreQueueFileSectionDecode (
+  IN EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
+  IN CONST EFI_GUID                 *FileName
+  )
+{
+  EFI_STATUS                    Status;
+  VOID                          *Buffer;
+  UINTN                         BufferSize;
+  EFI_FV_FILETYPE               FileType;
+  EFI_FV_FILE_ATTRIBUTES        FileAttributes;
+  UINT32                        AuthenticationStatus;
+  SECTION_DECODE_FILE           *File;
+  UINTN                         JobCount;
+  UINTN                         Offset;
+  EFI_COMMON_SECTION_HEADER     *Section;
+  UINT32                        SectionSize;
+
+  Buffer     = NULL;
+  BufferSize = 0;
+  Status = Fv->ReadFile (
+                 Fv,
+                 FileName,
+                 &Buffer,
+                 &BufferSize,
+                 &FileType,
+                 &FileAttributes,
+                 &AuthenticationStatus
+                 );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  File = AllocatePool (sizeof (SECTION_DECODE_FILE));
+  if (File == NULL) {
+    CoreFreePool (Buffer);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  JobCount = mSectionDecodeJobCount;
+
+  //
+  // The file data is a section stream. Only the top level sections are
+  // examined, the sections they encapsulate are not known until decoded.
+  //
+  Offset = 0;
+  while (Offset + sizeof (EFI_COMMON_SECTION_HEADER) <= BufferSize) {
+    Section     = (EFI_COMMON_SECTION_HEADER *) ((UINT8 *) Buffer + Offset);
+    SectionSize = SECTION_SIZE (Section);
+    if (IS_SECTION2 (Section)) {
+      if (Offset + sizeof (EFI_COMMON_SECTION_HEADER2) > BufferSize) {
+        break;
+      }
+      SectionSize = SECTION2_SIZE (Section);
+    }
+    if ((SectionSize < sizeof (EFI_COMMON_SECTION_HEADER)) || (SectionSize > BufferSize - Offset)) {
+      break;
+    }
+
+    Status = CoreQueueSectionDecodeJob (Section, SectionSize);
+    if (Status == EFI_OUT_OF_RESOURCES) {
+      break;
+    }
+
+    Offset = ALIGN_VALUE (Offset + SectionSize, 4);
+  }
+
+  if (mSectionDecodeJobCount == JobCount) {
+    CoreFreePool (File);
+    CoreFreePool (Buffer);
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // The queued jobs point into the file buffer, so keep it until the decode
+  // cache is flushed.
+  //
+  File->Signature = SECTION_DECODE_FILE_SIGNATURE;
+  File->Buffer    = Buffer;
+  InsertTailList (&mSectionDecodeFileList, &File->Link);
+  mSectionDecodeBatchSize += BufferSize;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Decode the section of a job into the buffers allocated for it.
+
+  @param  Job             The decode job to run.
+
+**/
+STATIC
+VOID
+CoreRunSectionDecodeJob (
+  IN OUT SECTION_DECODE_JOB  *Job
+  )
+{
+  Job->DecodedBuffer = Job->OutputBuffer;
+  if (Job->Type == EFI_SECTION_COMPRESSION) {
+    Job->Status = UefiDecompress (Job->Source, Job->OutputBuffer, Job->ScratchBuffer);
+  } else {
+    Job->Status = ExtractGuidedSectionDecode (
+                    Job->Section,
+                    &Job->DecodedBuffer,
+                    Job->ScratchBuffer,
+                    &Job->AuthenticationStatus
+                    );
+  }
+}
+
+/**
+  Run the share of the decode jobs that belongs to the calling processor.
+  This function is run concurrently by the BSP and the APs, so it must not
+  call any boot service.
+
+  @param  Buffer          Pointer to the SECTION_DECODE_CONTEXT of the run.
+
+**/
+VOID
+EFIAPI
+CoreSectionDecodeWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  SECTION_DECODE_CONTEXT  *Context;
+  UINTN                   ProcessorNumber;
+  UINTN                   Index;
+
+  Context = (SECTION_DECODE_CONTEXT *) Buffer;
+
+  Status = Context->MpServices->WhoAmI (Context->MpServices, &ProcessorNumber);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  for (Index = ProcessorNumber; Index < Context->JobCount; Index += Context->NumberOfProcessors) {
+    CoreRunSectionDecodeJob (Context->Jobs[Index]);
+  }
+}
+
+/**
+  Decode the encapsulation sections of a batch of files taken from the head
+  of the scheduled queue on the BSP and the enabled APs, and wait for the
+  decoding to complete. The jobs that fail are discarded, the others stay in
+  the cache until they are taken by the section extraction code or flushed.
+
+  Files are added to the batch until SECTION_DECODE_MAX_BATCH_SIZE bytes are
+  held by it, so the memory used does not grow with the length of the queue.
+
+  Nothing is decoded if the MP Services Protocol is not installed yet or if
+  there is no enabled AP, the sections are then decoded on demand as usual.
+
+  @param  ScheduledQueue  The list of EFI_CORE_DRIVER_ENTRY about to be dispatched.
+
+  @return The number of entries at the head of ScheduledQueue covered by the
+          batch. The next batch should be decoded once they are dispatched.
+
+**/
+UINTN
+CoreDecodeScheduledSections (
+  IN LIST_ENTRY  *ScheduledQueue
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  UINTN                     NumberOfProcessors;
+  UINTN                     NumberOfEnabledProcessors;
+  EFI_CORE_DRIVER_ENTRY     *DriverEntry;
+  SECTION_DECODE_CONTEXT    Context;
+  LIST_ENTRY                *Link;
+  SECTION_DECODE_JOB        *Job;
+  EFI_EVENT                 WaitEvent;
+  UINTN                     Index;
+  UINTN                     EntryCount;
+
+  //
+  // Without the MP Services Protocol, the whole queue is covered so that it
+  // is only looked for again in the next round of dispatch.
+  //
+  EntryCount = 0;
+  for (Link = ScheduledQueue->ForwardLink; Link != ScheduledQueue; Link = Link->ForwardLink) {
+    EntryCount++;
+  }
+
+  Status = CoreLocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **) &MpServices);
+  if (EFI_ERROR (Status)) {
+    return EntryCount;
+  }
+  Status = MpServices->GetNumberOfProcessors (MpServices, &NumberOfProcessors, &NumberOfEnabledProcessors);
+  if (EFI_ERROR (Status) || (NumberOfEnabledProcessors < 2)) {
+    return EntryCount;
+  }
+
+  EntryCount = 0;
+  for (Link = ScheduledQueue->ForwardLink; Link != ScheduledQueue; Link = Link->ForwardLink) {
+    if (mSectionDecodeBatchSize >= SECTION_DECODE_MAX_BATCH_SIZE) {
+      break;
+    }
+    EntryCount++;
+
+    DriverEntry = CR (Link, EFI_CORE_DRIVER_ENTRY, ScheduledLink, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
+    //
+    // A driver that was transitioned from Untrusted has already been loaded.
+    //
+    if (DriverEntry->ImageHandle != NULL) {
+      continue;
+    }
+    Status = CoreQueueFileSectionDecode (DriverEntry->Fv, &DriverEntry->FileName);
+    if (Status == EFI_OUT_OF_RESOURCES) {
+      break;
+    }
+  }
+
+  if (mSectionDecodeJobCount == 0) {
+    CoreFlushDecodedSections ();
+    return EntryCount;
+  }
+
+  Context.Jobs = AllocatePool (mSectionDecodeJobCount * sizeof (SECTION_DECODE_JOB *));
+  if (Context.Jobs == NULL) {
+    CoreFlushDecodedSections ();
+    return EntryCount;
+  }
+  Context.MpServices         = MpServices;
+  Context.NumberOfProcessors = NumberOfProcessors;
+  Context.JobCount           = 0;
+  for (Link = mSectionDecodeJobList.ForwardLink; Link != &mSectionDecodeJobList; Link = Link->ForwardLink) {
+    Context.Jobs[Context.JobCount++] = CR (Link, SECTION_DECODE_JOB, Link, SECTION_DECODE_JOB_SIGNATURE);
+  }
+
+  //
+  // Let the APs start on their share of the jobs, and have the BSP run its
+  // own. If the APs can't be started in non-blocking mode, they are run to
+  // completion first.
+  //
+  Status = CoreCreateEvent (0, TPL_CALLBACK, NULL, NULL, &WaitEvent);
+  if (!EFI_ERROR (Status)) {
+    Status = MpServices->StartupAllAPs (
+                           MpServices,
+                           CoreSectionDecodeWorker,
+                           FALSE,
+                           WaitEvent,
+                           0,
+                           &Context,
+                           NULL
+                           );
+    if (EFI_ERROR (Status)) {
+      CoreCloseEvent (WaitEvent);
+    }
+  }
+  if (EFI_ERROR (Status)) {
+    WaitEvent = NULL;
+    MpServices->StartupAllAPs (
+                  MpServices,
+                  CoreSectionDecodeWorker,
+                  FALSE,
+                  NULL,
+                  0,
+                  &Context,
+                  NULL
+                  );
+  }
+
+  CoreSectionDecodeWorker (&Context);
+
+  if (WaitEvent != NULL) {
+    CoreWaitForEvent (1, &WaitEvent, &Index);
+    CoreCloseEvent (WaitEvent);
+  }
+
+  //
+  // The shares of the disabled processors, and of the APs that could not be
+  // started, are left to the BSP.
+  //
+  for (Index = 0; Index < Context.JobCount; Index++) {
+    if (Context.Jobs[Index]->Status == RETURN_NOT_STARTED) {
+      CoreRunSectionDecodeJob (Context.Jobs[Index]);
+    }
+  }
+
+  CoreFreePool (Context.Jobs);
+
+  //
+  // Keep the output buffers of the successful jobs, the scratch buffers are
+  // no longer needed.
+  //
+  Link = mSectionDecodeJobList.ForwardLink;
+  while (Link != &mSectionDecodeJobList) {
+    Job  = CR (Link, SECTION_DECODE_JOB, Link, SECTION_DECODE_JOB_SIGNATURE);
+    Link = Link->ForwardLink;
+
+    if (RETURN_ERROR (Job->Status)) {
+      RemoveEntryList (&Job->Link);
+      mSectionDecodeJobCount--;
+      CoreFreeSectionDecodeJob (Job);
+      continue;
+    }
+
+    if (Job->DecodedBuffer != Job->OutputBuffer) {
+      //
+      // The decoder returned the data in place, so copy it to the buffer
+      // that will be handed out.
+      //
+      CopyMem (Job->OutputBuffer, Job->DecodedBuffer, Job->OutputSize);
+      Job->DecodedBuffer = Job->OutputBuffer;
+    }
+
+    if (Job->ScratchBuffer != NULL) {
+      CoreFreePool (Job->ScratchBuffer);
+      Job->ScratchBuffer = NULL;
+    }
+  }
+
+  return EntryCount;
+}
+
+/**
+  Look for an encapsulation section in the decode cache. On success, the
+  decoded buffer is removed from the cache and owned by the caller.
+
+  @param  Section               The encapsulation section, including its header.
+  @param  SectionSize           The size of the section.
+  @param  OutputBuffer          Returns the pool buffer holding the decoded data.
+  @param  OutputSize            Returns the size of the decoded data.
+  @param  AuthenticationStatus  Returns the authentication status reported by
+                                the decoder of a GUIDed section.
+
+  @retval TRUE    The section was found in the cache.
+  @retval FALSE   The section must be decoded by the caller.
+
+**/
+BOOLEAN
+CoreTakeDecodedSection (
+  IN  CONST VOID  *Section,
+  IN  UINTN       SectionSize,
+  OUT VOID        **OutputBuffer,
+  OUT UINTN       *OutputSize,
+  OUT UINT32      *AuthenticationStatus
+  )
+{
+  LIST_ENTRY          *Link;
+  SECTION_DECODE_JOB  *Job;
+
+  for (Link = mSectionDecodeJobList.ForwardLink; Link != &mSectionDecodeJobList; Link = Link->ForwardLink) {
+    Job = CR (Link, SECTION_DECODE_JOB, Link, SECTION_DECODE_JOB_SIGNATURE);
+    if ((Job->Status != RETURN_SUCCESS) || (Job->SectionSize != SectionSize)) {
+      continue;
+    }
+    if ((Job->Section != Section) && (CompareMem (Job->Section, Section, SectionSize) != 0)) {
+      continue;
+    }
+
+    *OutputBuffer         = Job->OutputBuffer;
+    *OutputSize           = Job->OutputSize;
+    *AuthenticationStatus = Job->AuthenticationStatus;
+
+    Job->OutputBuffer = NULL;
+    RemoveEntryList (&Job->Link);
+    mSectionDecodeJobCount--;
+    CoreFreeSectionDecodeJob (Job);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/**
+  Free all the decoded sections that were not taken, and the file copies they
+  were decoded from.
+
+**/
+VOID
+CoreFlushDecodedSections (
+  VOID
+  )
+{
+  SECTION_DECODE_JOB   *Job;
+  SECTION_DECODE_FILE  *File;
+
+  while (!IsListEmpty (&mSectionDecodeJobList)) {
+    Job = CR (mSectionDecodeJobList.ForwardLink, SECTION_DECODE_JOB, Link, SECTION_DECODE_JOB_SIGNATURE);
+    RemoveEntryList (&Job->Link);
+    CoreFreeSectionDecodeJob (Job);
+  }
+  mSectionDecodeJobCount  = 0;
+  mSectionDecodeBatchSize = 0;
+
+  while (!IsListEmpty (&mSectionDecodeFileList)) {
+    File = CR (mSectionDecodeFileList.ForwardLink, SECTION_DECODE_FILE, Link, SECTION_DECODE_FILE_SIGNATURE);
+    RemoveEntryList (&File->Link);
+    CoreFreePool (File->Buffer);
+    CoreFreePool (File);
+  }
+}
@@ -2155,6 +2155,28 @@ NetAddChecksum (
   IN UINT16                 Checksum2
   );
 
+/**
+  Update a checksum after one 16-bit word covered by it is changed, without
+  computing the checksum over the data again (RFC 1624).
+
+  Checksum, OldValue and NewValue must be in the same byte order, for example
+  all read from the packet as stored.
+
+  @param[in]   Checksum              The checksum field before the change.
+  @param[in]   OldValue              The 16-bit word before the change.
+  @param[in]   NewValue              The 16-bit word after the change.
+
+  @return         The checksum field after the change.
+
+**/
+UINT16
+EFIAPI
+NetUpdateChecksum (
+  IN UINT16                 Checksum,
+  IN UINT16                 OldValue,
+  IN UINT16                 NewValue
+  );
+
 /**
   Compute the checksum for a NET_BUF.
 
@@ -0,0 +1,82 @@
+/** @file
+  Memory Attribute Batch Protocol allows a caller to hand a list of memory
+  attribute updates to the CPU driver so that they are applied with a single
+  paging structure update pass and a single TLB flush.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#ifndef __MEMORY_ATTRIBUTE_BATCH_H__
+#define __MEMORY_ATTRIBUTE_BATCH_H__
+
+//{C8F14A21-DC6C-4B8A-86ED-B69B4899A10E}
+#define EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL_GUID \
+  { \
+    0xc8f14a21, 0xdc6c, 0x4b8a, { 0x86, 0xed, 0xb6, 0x9b, 0x48, 0x99, 0xa1, 0x0e } \
+  }
+
+typedef struct _EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL;
+
+///
+/// One memory attribute update. Attributes has the same meaning as the
+/// Attributes parameter of EFI_CPU_ARCH_PROTOCOL.SetMemoryAttributes().
+///
+typedef struct {
+  EFI_PHYSICAL_ADDRESS    BaseAddress;
+  UINT64                  Length;
+  UINT64                  Attributes;
+} EDKII_MEMORY_ATTRIBUTE_RANGE;
+
+/**
+  This function applies a list of memory attribute updates.
+
+  The ranges are applied in the order they appear in the list, so a later
+  range overrides an earlier one where the two overlap. The result is the same
+  as calling EFI_CPU_ARCH_PROTOCOL.SetMemoryAttributes() once per range, but
+  the implementation is allowed to defer the TLB flush until all ranges have
+  been applied.
+
+  @param  This              The EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL instance.
+  @param  Ranges            Pointer to the list of memory attribute updates.
+  @param  RangeCount        Number of entries in Ranges.
+
+  @retval EFI_SUCCESS           The attributes were set for all memory regions.
+  @retval EFI_INVALID_PARAMETER Ranges is NULL and RangeCount is not zero.
+                                Length of one range is zero.
+                                Attributes of one range specified an illegal
+                                combination of attributes that cannot be set
+                                together.
+  @retval EFI_OUT_OF_RESOURCES  There are not enough system resources to modify
+                                the attributes of one memory region.
+  @retval EFI_UNSUPPORTED       The processor does not support one or more
+                                bytes of one memory region, or the attributes
+                                are not supported for that memory region.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_SET_MEMORY_ATTRIBUTES_BATCH)(
+  IN  EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL   *This,
+  IN  CONST EDKII_MEMORY_ATTRIBUTE_RANGE      *Ranges,
+  IN  UINTN                                   RangeCount
+  );
+
+///
+/// Memory Attribute Batch Protocol applies several memory attribute updates
+/// in one go.
+///
+struct _EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL {
+  EDKII_SET_MEMORY_ATTRIBUTES_BATCH     SetMemoryAttributesBatch;
+};
+
+extern EFI_GUID gEdkiiMemoryAttributeBatchProtocolGuid;
+
+#endif
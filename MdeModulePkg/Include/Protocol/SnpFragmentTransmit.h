@@ -0,0 +1,104 @@
+/** @file
+  SNP Fragment Transmit Protocol allows a caller to transmit a packet that is
+  described by a list of fragments, so that the packet does not need to be
+  copied into one contiguous buffer first. It is installed on the same handle
+  as the Simple Network Protocol it extends.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#ifndef __SNP_FRAGMENT_TRANSMIT_H__
+#define __SNP_FRAGMENT_TRANSMIT_H__
+
+#include <Protocol/SimpleNetwork.h>
+
+//{DA4D6890-B0FA-49ED-9538-426FF7941EA1}
+#define EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL_GUID \
+  { \
+    0xda4d6890, 0xb0fa, 0x49ed, { 0x95, 0x38, 0x42, 0x6f, 0xf7, 0x94, 0x1e, 0xa1 } \
+  }
+
+typedef struct _EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL;
+
+///
+/// One fragment of the packet to transmit.
+///
+typedef struct {
+  UINT32    FragmentLength;
+  VOID      *FragmentBuffer;
+} EDKII_SNP_FRAGMENT_DATA;
+
+/**
+  Places a packet described by a list of fragments in the transmit queue of
+  a network interface.
+
+  This function behaves as EFI_SIMPLE_NETWORK_PROTOCOL.Transmit(), except that
+  the packet is the concatenation of the fragments in FragmentTable. The first
+  fragment starts with the media header and must hold the whole media header.
+  When the packet has actually been transmitted, FragmentTable[0].FragmentBuffer
+  is returned as the recycled transmit buffer by
+  EFI_SIMPLE_NETWORK_PROTOCOL.GetStatus(). None of the fragments may be modified
+  or freed until then.
+
+  @param  This          The EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL instance.
+  @param  HeaderSize    The size, in bytes, of the media header to be filled in
+                        by this function. If HeaderSize is nonzero, then it must
+                        be equal to the MediaHeaderSize of the Simple Network
+                        Protocol mode and the DestAddr and Protocol parameters
+                        must not be NULL.
+  @param  FragmentCount The number of entries in FragmentTable. It must not be
+                        larger than MaxFragmentCount.
+  @param  FragmentTable The fragments of the packet, media header first.
+  @param  SrcAddr       The source HW MAC address. If HeaderSize is nonzero and
+                        SrcAddr is NULL, then the current station address is used.
+  @param  DestAddr      The destination HW MAC address. If HeaderSize is zero,
+                        then this parameter is ignored.
+  @param  Protocol      The type of header to build. If HeaderSize is zero, then
+                        this parameter is ignored.
+
+  @retval EFI_SUCCESS           The packet was placed on the transmit queue.
+  @retval EFI_NOT_STARTED       The network interface has not been started.
+  @retval EFI_NOT_READY         The network interface is too busy to accept this
+                                transmit request.
+  @retval EFI_BUFFER_TOO_SMALL  The first fragment is too small to hold the media
+                                header.
+  @retval EFI_INVALID_PARAMETER One or more of the parameters has an unsupported
+                                value.
+  @retval EFI_DEVICE_ERROR      The command could not be sent to the network interface.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_SNP_TRANSMIT_FRAGMENTS)(
+  IN EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL   *This,
+  IN UINTN                                  HeaderSize,
+  IN UINT32                                 FragmentCount,
+  IN EDKII_SNP_FRAGMENT_DATA                *FragmentTable,
+  IN EFI_MAC_ADDRESS                        *SrcAddr,  OPTIONAL
+  IN EFI_MAC_ADDRESS                        *DestAddr, OPTIONAL
+  IN UINT16                                 *Protocol  OPTIONAL
+  );
+
+///
+/// SNP Fragment Transmit Protocol transmits a packet without copying its
+/// fragments into one buffer.
+///
+struct _EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL {
+  ///
+  /// The maximum number of fragments accepted by TransmitFragments().
+  ///
+  UINT32                                MaxFragmentCount;
+  EDKII_SNP_TRANSMIT_FRAGMENTS          TransmitFragments;
+};
+
+extern EFI_GUID gEdkiiSnpFragmentTransmitProtocolGuid;
+
+#endif
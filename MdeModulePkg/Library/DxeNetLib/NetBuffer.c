@@ -19,6 +19,232 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+
+//
+// The NET_BUF, NET_VECTOR and data blocks allocated by this library are
+// recycled through per size class free lists, so that steady packet traffic
+// doesn't go to the pool allocator for every packet. Each class keeps at most
+// PcdNetBufPoolMaxCount free objects. Larger objects are allocated and freed
+// directly.
+//
+typedef struct {
+  UINT32                    Size;
+  LIST_ENTRY                FreeList;
+  UINT32                    FreeCount;
+  UINT32                    HitCount;
+  UINT32                    MissCount;
+  UINT32                    ReleaseCount;
+} NET_POOL_CLASS;
+
+NET_POOL_CLASS  mNetPoolClass[] = {
+  { 64,   INITIALIZE_LIST_HEAD_VARIABLE (mNetPoolClass[0].FreeList), 0, 0, 0, 0 },
+  { 128,  INITIALIZE_LIST_HEAD_VARIABLE (mNetPoolClass[1].FreeList), 0, 0, 0, 0 },
+  { 256,  INITIALIZE_LIST_HEAD_VARIABLE (mNetPoolClass[2].FreeList), 0, 0, 0, 0 },
+  { 512,  INITIALIZE_LIST_HEAD_VARIABLE (mNetPoolClass[3].FreeList), 0, 0, 0, 0 },
+  { 1024, INITIALIZE_LIST_HEAD_VARIABLE (mNetPoolClass[4].FreeList), 0, 0, 0, 0 },
+  { 2048, INITIALIZE_LIST_HEAD_VARIABLE (mNetPoolClass[5].FreeList), 0, 0, 0, 0 }
+};
+
+//
+// Every object allocated by NetPoolAllocate is preceded by this header. An
+// object is only put back on a free list if its header proves that it was
+// allocated by this instance of the library at the full size of the class.
+// The objects allocated elsewhere, such as by another module or by an older
+// version of this library, have no header and are freed directly.
+//
+#define NET_POOL_SIGNATURE        SIGNATURE_32 ('n', 'p', 'o', 'l')
+#define NET_POOL_CLASS_NONE       MAX_UINT32
+
+typedef struct {
+  UINT32                    Signature;
+  UINT32                    Class;   ///< Index in mNetPoolClass, or NET_POOL_CLASS_NONE.
+} NET_POOL_HEADER;
+
+/**
+  Find the size class to serve an object of Size bytes.
+
+  @param[in]  Size           The size of the object, in bytes.
+
+  @return                    Index of the smallest size class that holds the
+                             object, or NET_POOL_CLASS_NONE if the object is
+                             too big to be cached.
+
+**/
+UINT32
+NetPoolGetClass (
+  IN UINTN                  Size
+  )
+{
+  UINT32                    Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mNetPoolClass); Index++) {
+    if (Size <= mNetPoolClass[Index].Size) {
+      return Index;
+    }
+  }
+
+  return NET_POOL_CLASS_NONE;
+}
+
+/**
+  Allocate an object of Size bytes for the net buffer, from the free list of
+  its size class if possible. The content of the object is un-initialized.
+
+  The object is always allocated at the full size of its class, whatever the
+  value of PcdNetBufPoolMaxCount, so that it can be recycled.
+
+  @param[in]  Size           The size of the object, in bytes.
+
+  @return                    Pointer to the allocated object, or NULL if the
+                             allocation failed due to resource limit.
+
+**/
+VOID *
+NetPoolAllocate (
+  IN UINTN                  Size
+  )
+{
+  NET_POOL_CLASS            *Class;
+  NET_POOL_HEADER           *Header;
+  LIST_ENTRY                *Entry;
+  UINT32                    ClassIndex;
+  EFI_TPL                   OldTpl;
+
+  ClassIndex = NetPoolGetClass (Size);
+
+  if (ClassIndex != NET_POOL_CLASS_NONE) {
+    Class  = &mNetPoolClass[ClassIndex];
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+    if (!IsListEmpty (&Class->FreeList)) {
+      Entry = GetFirstNode (&Class->FreeList);
+      RemoveEntryList (Entry);
+      Class->FreeCount--;
+      Class->HitCount++;
+
+      gBS->RestoreTPL (OldTpl);
+      return Entry;
+    }
+
+    Class->MissCount++;
+    gBS->RestoreTPL (OldTpl);
+
+    Size = Class->Size;
+  }
+
+  if (Size > MAX_UINTN - sizeof (NET_POOL_HEADER)) {
+    return NULL;
+  }
+
+  Header = AllocatePool (sizeof (NET_POOL_HEADER) + Size);
+  if (Header == NULL) {
+    return NULL;
+  }
+
+  Header->Signature = NET_POOL_SIGNATURE;
+  Header->Class     = ClassIndex;
+
+  return Header + 1;
+}
+
+/**
+  Free an object of the net buffer. The object is kept on the free list of its
+  size class if it was allocated by NetPoolAllocate of this library instance
+  and the list isn't full.
+
+  @param[in]  Buffer         Pointer to the object to free.
+
+**/
+VOID
+NetPoolFree (
+  IN VOID                   *Buffer
+  )
+{
+  NET_POOL_CLASS            *Class;
+  NET_POOL_HEADER           *Header;
+  EFI_TPL                   OldTpl;
+
+  Header = (NET_POOL_HEADER *) Buffer - 1;
+
+  if (Header->Signature != NET_POOL_SIGNATURE) {
+    //
+    // Not allocated by NetPoolAllocate.
+    //
+    FreePool (Buffer);
+    return;
+  }
+
+  if (Header->Class < ARRAY_SIZE (mNetPoolClass)) {
+    Class  = &mNetPoolClass[Header->Class];
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+    if (Class->FreeCount < PcdGet32 (PcdNetBufPoolMaxCount)) {
+      InsertHeadList (&Class->FreeList, (LIST_ENTRY *) Buffer);
+      Class->FreeCount++;
+      gBS->RestoreTPL (OldTpl);
+      return;
+    }
+
+    Class->ReleaseCount++;
+    gBS->RestoreTPL (OldTpl);
+  }
+
+  Header->Signature = 0;
+  FreePool (Header);
+}
+
+/**
+  The destructor function of the library. It releases the objects cached on
+  the free lists of the net buffer size classes.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The destructor completed successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+NetbufPoolDestructor (
+  IN EFI_HANDLE             ImageHandle,
+  IN EFI_SYSTEM_TABLE       *SystemTable
+  )
+{
+  NET_POOL_CLASS            *Class;
+  NET_POOL_HEADER           *Header;
+  LIST_ENTRY                *Entry;
+  UINTN                     Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mNetPoolClass); Index++) {
+    Class = &mNetPoolClass[Index];
+
+    if ((Class->HitCount != 0) || (Class->MissCount != 0)) {
+      DEBUG (
+        (EFI_D_INFO,
+        "NetbufPool: %d byte class, %d hits, %d misses, %d released, %d cached\n",
+        Class->Size,
+        Class->HitCount,
+        Class->MissCount,
+        Class->ReleaseCount,
+        Class->FreeCount)
+        );
+    }
+
+    while (!IsListEmpty (&Class->FreeList)) {
+      Entry = GetFirstNode (&Class->FreeList);
+      RemoveEntryList (Entry);
+
+      Header            = (NET_POOL_HEADER *) Entry - 1;
+      Header->Signature = 0;
+      FreePool (Header);
+    }
+
+    Class->FreeCount = 0;
+  }
+
+  return EFI_SUCCESS;
+}
 
 
 /**
@@ -49,24 +275,28 @@ NetbufAllocStruct (
   //
   // Allocate three memory blocks.
   //
-  Nbuf = AllocateZeroPool (NET_BUF_SIZE (BlockOpNum));
+  Nbuf = NetPoolAllocate (NET_BUF_SIZE (BlockOpNum));
 
   if (Nbuf == NULL) {
     return NULL;
   }
 
+  ZeroMem (Nbuf, NET_BUF_SIZE (BlockOpNum));
+
   Nbuf->Signature           = NET_BUF_SIGNATURE;
   Nbuf->RefCnt              = 1;
   Nbuf->BlockOpNum          = BlockOpNum;
   InitializeListHead (&Nbuf->List);
 
   if (BlockNum != 0) {
-    Vector = AllocateZeroPool (NET_VECTOR_SIZE (BlockNum));
+    Vector = NetPoolAllocate (NET_VECTOR_SIZE (BlockNum));
 
     if (Vector == NULL) {
       goto FreeNbuf;
     }
 
+    ZeroMem (Vector, NET_VECTOR_SIZE (BlockNum));
+
     Vector->Signature = NET_VECTOR_SIGNATURE;
     Vector->RefCnt    = 1;
     Vector->BlockNum  = BlockNum;
@@ -77,7 +307,7 @@ NetbufAllocStruct (
 
 FreeNbuf:
 
-  FreePool (Nbuf);
+  NetPoolFree (Nbuf);
   return NULL;
 }
 
@@ -110,7 +340,7 @@ NetbufAlloc (
     return NULL;
   }
 
-  Bulk = AllocatePool (Len);
+  Bulk = NetPoolAllocate (Len);
 
   if (Bulk == NULL) {
     goto FreeNBuf;
@@ -132,7 +362,8 @@ NetbufAlloc (
   return Nbuf;
 
 FreeNBuf:
-  FreePool (Nbuf);
+  NetPoolFree (Nbuf->Vector);
+  NetPoolFree (Nbuf);
   return NULL;
 }
 
@@ -170,7 +401,7 @@ NetbufFreeVector (
     // first block since it is allocated by us
     //
     if ((Vector->Flag & NET_VECTOR_OWN_FIRST) != 0) {
-      gBS->FreePool (Vector->Block[0].Bulk);
+      NetPoolFree (Vector->Block[0].Bulk);
     }
 
     Vector->Free (Vector->Arg);
@@ -180,11 +411,11 @@ NetbufFreeVector (
     // Free each memory block associated with the Vector
     //
     for (Index = 0; Index < Vector->BlockNum; Index++) {
-      gBS->FreePool (Vector->Block[Index].Bulk);
+      NetPoolFree (Vector->Block[Index].Bulk);
     }
   }
 
-  FreePool (Vector);
+  NetPoolFree (Vector);
 }
 
 
@@ -218,7 +449,7 @@ NetbufFree (
     // all the sharing of Nbuf increse Vector's RefCnt by one
     //
     NetbufFreeVector (Nbuf->Vector);
-    FreePool (Nbuf);
+    NetPoolFree (Nbuf);
   }
 }
 
@@ -245,7 +476,7 @@ NetbufClone (
 
   NET_CHECK_SIGNATURE (Nbuf, NET_BUF_SIGNATURE);
 
-  Clone = AllocatePool (NET_BUF_SIZE (Nbuf->BlockOpNum));
+  Clone = NetPoolAllocate (NET_BUF_SIZE (Nbuf->BlockOpNum));
 
   if (Clone == NULL) {
     return NULL;
@@ -618,7 +849,7 @@ NetbufGetFragment (
       return NULL;
     }
 
-    FirstBulk = AllocatePool (HeadSpace);
+    FirstBulk = NetPoolAllocate (HeadSpace);
 
     if (FirstBulk == NULL) {
       goto FreeChild;
@@ -685,7 +916,8 @@ NetbufGetFragment (
 
 FreeChild:
 
-  FreePool (Child);
+  NetPoolFree (Child->Vector);
+  NetPoolFree (Child);
   return NULL;
 }
 
@@ -767,7 +999,7 @@ NetbufFromExt (
   //
   if ((HeadSpace != 0) || (HeadLen != 0)) {
     FirstBlockLen = HeadLen + HeadSpace;
-    FirstBlock    = AllocatePool (FirstBlockLen);
+    FirstBlock    = NetPoolAllocate (FirstBlockLen);
 
     if (FirstBlock == NULL) {
       return NULL;
@@ -868,7 +1100,7 @@ NetbufFromExt (
 
 FreeFirstBlock:
   if (FirstBlock != NULL) {
-    FreePool (FirstBlock);
+    NetPoolFree (FirstBlock);
   }
   return NULL;
 }
@@ -1648,6 +1880,9 @@ NetbufQueFlush (
 /**
   Compute the checksum for a bulk of data.
 
+  The data is summed 32 bits at a time from aligned addresses into a 64-bit
+  accumulator, the carries are folded back once at the end.
+
   @param[in]   Bulk                  Pointer to the data.
   @param[in]   Len                   Length of the data, in bytes.
 
@@ -1661,32 +1896,75 @@ NetblockChecksum (
   IN UINT32                 Len
   )
 {
-  register UINT32           Sum;
+  UINT64                    Sum;
+  UINT32                    Sum32;
+  UINT32                    *Bulk32;
+  BOOLEAN                   Odd;
 
   Sum = 0;
+  Odd = FALSE;
 
   //
-  // Add left-over byte, if any
+  // If the data starts at an odd address, sum it from the next byte. The sum
+  // of the data shifted by one byte is the byte swapped sum, so the first
+  // byte goes to the high half and the result is swapped back at the end.
   //
-  if (Len % 2 != 0) {
-    Sum += *(Bulk + Len - 1);
+  if ((((UINTN) Bulk & 0x01) != 0) && (Len != 0)) {
+    Odd  = TRUE;
+    Sum  = (UINT32) *Bulk << 8;
+    Bulk++;
+    Len--;
   }
 
-  while (Len > 1) {
-    Sum += *(UINT16 *) Bulk;
+  if ((((UINTN) Bulk & 0x02) != 0) && (Len >= 2)) {
+    Sum  += *(UINT16 *) Bulk;
     Bulk += 2;
-    Len -= 2;
+    Len  -= 2;
+  }
+
+  Bulk32 = (UINT32 *) Bulk;
+  while (Len >= 16) {
+    Sum    += (UINT64) Bulk32[0] + Bulk32[1] + Bulk32[2] + Bulk32[3];
+    Bulk32 += 4;
+    Len    -= 16;
+  }
+
+  while (Len >= 4) {
+    Sum += *Bulk32;
+    Bulk32++;
+    Len -= 4;
+  }
+
+  Bulk = (UINT8 *) Bulk32;
+  if (Len >= 2) {
+    Sum  += *(UINT16 *) Bulk;
+    Bulk += 2;
+    Len  -= 2;
   }
 
   //
-  // Fold 32-bit sum to 16 bits
+  // Add left-over byte, if any
   //
-  while ((Sum >> 16) != 0) {
-    Sum = (Sum & 0xffff) + (Sum >> 16);
+  if (Len != 0) {
+    Sum += *Bulk;
+  }
+
+  //
+  // Fold 64-bit sum to 16 bits
+  //
+  Sum   = (Sum & 0xffffffff) + RShiftU64 (Sum, 32);
+  Sum   = (Sum & 0xffffffff) + RShiftU64 (Sum, 32);
+  Sum32 = (UINT32) Sum;
 
+  while ((Sum32 >> 16) != 0) {
+    Sum32 = (Sum32 & 0xffff) + (Sum32 >> 16);
   }
 
-  return (UINT16) Sum;
+  if (Odd) {
+    return SwapBytes16 ((UINT16) Sum32);
+  }
+
+  return (UINT16) Sum32;
 }
 
 
@@ -1722,6 +2000,38 @@ NetAddChecksum (
 }
 
 
+/**
+  Update a checksum after one 16-bit word covered by it is changed, without
+  computing the checksum over the data again (RFC 1624).
+
+  Checksum, OldValue and NewValue must be in the same byte order, for example
+  all read from the packet as stored.
+
+  @param[in]   Checksum              The checksum field before the change.
+  @param[in]   OldValue              The 16-bit word before the change.
+  @param[in]   NewValue              The 16-bit word after the change.
+
+  @return         The checksum field after the change.
+
+**/
+UINT16
+EFIAPI
+NetUpdateChecksum (
+  IN UINT16                 Checksum,
+  IN UINT16                 OldValue,
+  IN UINT16                 NewValue
+  )
+{
+  //
+  // HC' = ~(~HC + ~m + m')
+  //
+  return (UINT16) ~NetAddChecksum (
+                     NetAddChecksum ((UINT16) ~Checksum, (UINT16) ~OldValue),
+                     NewValue
+                     );
+}
+
+
 /**
   Compute the checksum for a NET_BUF.
 
@@ -1887,10 +2197,10 @@ NetIpSecNetbufFree (
     // allocated by us
     //
     if ((Nbuf->Vector->Flag & NET_VECTOR_OWN_FIRST) != 0) {
-      FreePool (Nbuf->Vector->Block[0].Bulk);
+      NetPoolFree (Nbuf->Vector->Block[0].Bulk);
     }
-    FreePool (Nbuf->Vector);
-    FreePool (Nbuf);
+    NetPoolFree (Nbuf->Vector);
+    NetPoolFree (Nbuf);
   }
 }
 
@@ -181,6 +181,7 @@ DiskIoDriverBindingStart (
           ));
 
   InitializeListHead (&Instance->TaskQueue);
+  InitializeListHead (&Instance->PendingBlockReads);
   EfiInitializeLock (&Instance->TaskQueueLock, TPL_NOTIFY);
   Instance->SharedWorkingBuffer = AllocateAlignedPages (
                                     EFI_SIZE_TO_PAGES (PcdGet32 (PcdDiskIoDataBufferBlockNum) * Instance->BlockIo->Media->BlockSize),
@@ -394,25 +395,20 @@ DiskIoDestroySubtask (
 }
 
 /**
-  The callback for the BlockIo2 ReadBlocksEx/WriteBlocksEx.
-  @param  Event                 Event whose notification function is being invoked.
-  @param  Context               The pointer to the notification function's context,
-                                which points to the DISK_IO_SUBTASK instance.
+  Complete a non-blocking subtask.
+
+  @param Subtask            The subtask.
+  @param TransactionStatus  The status of the BlockIo2 request of the subtask.
 **/
 VOID
-EFIAPI
-DiskIo2OnReadWriteComplete (
-  IN EFI_EVENT            Event,
-  IN VOID                 *Context
+DiskIo2CompleteSubtask (
+  IN DISK_IO_SUBTASK      *Subtask,
+  IN EFI_STATUS           TransactionStatus
   )
 {
-  DISK_IO_SUBTASK       *Subtask;
   DISK_IO2_TASK         *Task;
-  EFI_STATUS            TransactionStatus;
   DISK_IO_PRIVATE_DATA  *Instance;
 
-  Subtask           = (DISK_IO_SUBTASK *) Context;
-  TransactionStatus = Subtask->BlockIo2Token.TransactionStatus;
   Task              = Subtask->Task;
   Instance          = Task->Instance;
 
@@ -445,6 +441,172 @@ DiskIo2OnReadWriteComplete (
   }
 }
 
+/**
+  Queue a non-blocking partial block read.
+
+  If a non-blocking partial read of the same block is already in flight, the
+  subtask is attached to it and completes together with it. Otherwise the
+  subtask is recorded as in flight so that later reads of the block can be
+  attached to it, and the caller must submit it.
+
+  Sharing is only correct if the blocks are written through this instance,
+  which is what DiskIo2UnshareBlockReads() relies on. Writes issued directly
+  through the Block I/O protocols of the device are not seen here; for this
+  reason the partition driver does not pass writes to the parent Block I/O
+  protocols.
+
+  @param Instance     Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Subtask      The non-blocking partial block read subtask.
+
+  @retval TRUE        The subtask is attached to a read in flight.
+  @retval FALSE       The caller must submit the subtask.
+**/
+BOOLEAN
+DiskIo2QueueBlockRead (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN DISK_IO_SUBTASK          *Subtask
+  )
+{
+  LIST_ENTRY                  *Link;
+  DISK_IO_SUBTASK             *Pending;
+  BOOLEAN                     Attached;
+
+  Attached = FALSE;
+
+  EfiAcquireLock (&Instance->TaskQueueLock);
+  for ( Link = GetFirstNode (&Instance->PendingBlockReads)
+      ; !IsNull (&Instance->PendingBlockReads, Link)
+      ; Link = GetNextNode (&Instance->PendingBlockReads, Link)
+      ) {
+    Pending = CR (Link, DISK_IO_SUBTASK, PendingLink, DISK_IO_SUBTASK_SIGNATURE);
+    if (Pending->Lba == Subtask->Lba) {
+      InsertTailList (&Pending->Sharers, &Subtask->PendingLink);
+      Attached = TRUE;
+      break;
+    }
+  }
+
+  if (!Attached) {
+    InsertTailList (&Instance->PendingBlockReads, &Subtask->PendingLink);
+  }
+  EfiReleaseLock (&Instance->TaskQueueLock);
+
+  return Attached;
+}
+
+/**
+  Stop sharing the in-flight partial block reads of the blocks a write is
+  about to modify.
+
+  The reads are taken off Instance->PendingBlockReads, so that the reads
+  queued after the write don't get the data from before it. They still
+  complete the subtasks already attached to them.
+
+  @param Instance     Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Lba          The first block written.
+  @param BlockCount   The number of blocks written.
+**/
+VOID
+DiskIo2UnshareBlockReads (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN UINT64                   Lba,
+  IN UINT64                   BlockCount
+  )
+{
+  LIST_ENTRY                  *Link;
+  DISK_IO_SUBTASK             *Pending;
+
+  EfiAcquireLock (&Instance->TaskQueueLock);
+  Link = GetFirstNode (&Instance->PendingBlockReads);
+  while (!IsNull (&Instance->PendingBlockReads, Link)) {
+    Pending = CR (Link, DISK_IO_SUBTASK, PendingLink, DISK_IO_SUBTASK_SIGNATURE);
+    Link    = GetNextNode (&Instance->PendingBlockReads, Link);
+    if ((Pending->Lba >= Lba) && (Pending->Lba - Lba < BlockCount)) {
+      //
+      // Leave the link pointing to itself, the read is still in flight.
+      //
+      RemoveEntryList (&Pending->PendingLink);
+      InitializeListHead (&Pending->PendingLink);
+    }
+  }
+  EfiReleaseLock (&Instance->TaskQueueLock);
+}
+
+/**
+  Remove an in-flight partial block read from Instance->PendingBlockReads and
+  complete the subtasks attached to it.
+
+  @param Instance           Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Subtask            The partial block read subtask.
+  @param TransactionStatus  The status of the block read.
+**/
+VOID
+DiskIo2CompleteBlockReadSharers (
+  IN DISK_IO_PRIVATE_DATA     *Instance,
+  IN DISK_IO_SUBTASK          *Subtask,
+  IN EFI_STATUS               TransactionStatus
+  )
+{
+  LIST_ENTRY                  Sharers;
+  LIST_ENTRY                  *Link;
+  DISK_IO_SUBTASK             *Sharer;
+
+  if (Subtask->PendingLink.ForwardLink == NULL) {
+    return;
+  }
+
+  InitializeListHead (&Sharers);
+
+  EfiAcquireLock (&Instance->TaskQueueLock);
+  RemoveEntryList (&Subtask->PendingLink);
+  Subtask->PendingLink.ForwardLink = NULL;
+  while (!IsListEmpty (&Subtask->Sharers)) {
+    Link = GetFirstNode (&Subtask->Sharers);
+    RemoveEntryList (Link);
+    InsertTailList (&Sharers, Link);
+  }
+  EfiReleaseLock (&Instance->TaskQueueLock);
+
+  while (!IsListEmpty (&Sharers)) {
+    Link   = GetFirstNode (&Sharers);
+    RemoveEntryList (Link);
+    Sharer = CR (Link, DISK_IO_SUBTASK, PendingLink, DISK_IO_SUBTASK_SIGNATURE);
+    Sharer->PendingLink.ForwardLink = NULL;
+    if (!EFI_ERROR (TransactionStatus)) {
+      CopyMem (Sharer->WorkingBuffer, Subtask->WorkingBuffer, Instance->BlockIo->Media->BlockSize);
+    }
+    DiskIo2CompleteSubtask (Sharer, TransactionStatus);
+  }
+}
+
+/**
+  The callback for the BlockIo2 ReadBlocksEx/WriteBlocksEx.
+  @param  Event                 Event whose notification function is being invoked.
+  @param  Context               The pointer to the notification function's context,
+                                which points to the DISK_IO_SUBTASK instance.
+**/
+VOID
+EFIAPI
+DiskIo2OnReadWriteComplete (
+  IN EFI_EVENT            Event,
+  IN VOID                 *Context
+  )
+{
+  DISK_IO_SUBTASK       *Subtask;
+  EFI_STATUS            TransactionStatus;
+
+  Subtask           = (DISK_IO_SUBTASK *) Context;
+  TransactionStatus = Subtask->BlockIo2Token.TransactionStatus;
+
+  ASSERT (Subtask->Signature == DISK_IO_SUBTASK_SIGNATURE);
+
+  //
+  // The subtasks sharing the block need its data before it is freed.
+  //
+  DiskIo2CompleteBlockReadSharers (Subtask->Task->Instance, Subtask, TransactionStatus);
+  DiskIo2CompleteSubtask (Subtask, TransactionStatus);
+}
+
 /**
   Create the subtask.
 
@@ -484,6 +646,7 @@ DiskIoCreateSubtask (
   Subtask->WorkingBuffer = WorkingBuffer;
   Subtask->Buffer        = Buffer;
   Subtask->Blocking      = Blocking;
+  InitializeListHead (&Subtask->Sharers);
   if (!Blocking) {
     Status = gBS->CreateEvent (
                     EVT_NOTIFY_SIGNAL,
@@ -606,34 +769,6 @@ DiskIoCreateSubtaskList (
   OverRunLba  = Lba + DivU64x32Remainder (BufferSize, BlockSize, &OverRun);
   BufferSize -= OverRun;
 
-  if (OverRun != 0) {
-    if (Blocking) {
-      WorkingBuffer = SharedWorkingBuffer;
-    } else {
-      WorkingBuffer = AllocateAlignedPages (EFI_SIZE_TO_PAGES (BlockSize), IoAlign);
-      if (WorkingBuffer == NULL) {
-        goto Done;
-      }
-    }
-    if (Write) {
-      //
-      // A half write operation can be splitted to a blocking block-read and half write operation
-      // This can simplify the sub task processing logic
-      //
-      Subtask = DiskIoCreateSubtask (FALSE, OverRunLba, 0, BlockSize, NULL, WorkingBuffer, TRUE);
-      if (Subtask == NULL) {
-        goto Done;
-      }
-      InsertTailList (Subtasks, &Subtask->Link);
-    }
-
-    Subtask = DiskIoCreateSubtask (Write, OverRunLba, 0, OverRun, WorkingBuffer, BufferPtr + BufferSize, Blocking);
-    if (Subtask == NULL) {
-      goto Done;
-    }
-    InsertTailList (Subtasks, &Subtask->Link);
-  }
-
   if (OverRunLba > Lba) {
     //
     // If the DiskIo maps directly to a BlockIo device do the read.
@@ -693,6 +828,38 @@ DiskIoCreateSubtaskList (
     }
   }
 
+  //
+  // The partial tail block is handled after the middle blocks so that the
+  // subtasks are submitted in ascending LBA order.
+  //
+  if (OverRun != 0) {
+    if (Blocking) {
+      WorkingBuffer = SharedWorkingBuffer;
+    } else {
+      WorkingBuffer = AllocateAlignedPages (EFI_SIZE_TO_PAGES (BlockSize), IoAlign);
+      if (WorkingBuffer == NULL) {
+        goto Done;
+      }
+    }
+    if (Write) {
+      //
+      // A half write operation can be splitted to a blocking block-read and half write operation
+      // This can simplify the sub task processing logic
+      //
+      Subtask = DiskIoCreateSubtask (FALSE, OverRunLba, 0, BlockSize, NULL, WorkingBuffer, TRUE);
+      if (Subtask == NULL) {
+        goto Done;
+      }
+      InsertTailList (Subtasks, &Subtask->Link);
+    }
+
+    Subtask = DiskIoCreateSubtask (Write, OverRunLba, 0, OverRun, WorkingBuffer, BufferPtr, Blocking);
+    if (Subtask == NULL) {
+      goto Done;
+    }
+    InsertTailList (Subtasks, &Subtask->Link);
+  }
+
   ASSERT (BufferSize == 0);
 
   return TRUE;
@@ -890,6 +1057,15 @@ DiskIo2ReadWriteDisk (
         CopyMem (Subtask->WorkingBuffer + Subtask->Offset, Subtask->Buffer, Subtask->Length);
       }
 
+      //
+      // Reads of these blocks must not share a read issued before the write.
+      //
+      DiskIo2UnshareBlockReads (
+        Instance,
+        Subtask->Lba,
+        (Subtask->Length % Media->BlockSize == 0) ? Subtask->Length / Media->BlockSize : 1
+        );
+
       if (SubtaskBlocking) {
         Status = BlockIo->WriteBlocks (
                             BlockIo,
@@ -924,6 +1100,13 @@ DiskIo2ReadWriteDisk (
         if (!EFI_ERROR (Status) && (Subtask->WorkingBuffer != NULL)) {
           CopyMem (Subtask->Buffer, Subtask->WorkingBuffer + Subtask->Offset, Subtask->Length);
         }
+      } else if ((Subtask->WorkingBuffer != NULL) && (Subtask->Length < Media->BlockSize) &&
+                 DiskIo2QueueBlockRead (Instance, Subtask)) {
+        //
+        // The block is being read for another request, so the subtask
+        // completes together with that read.
+        //
+        Status = EFI_SUCCESS;
       } else {
         Status = BlockIo2->ReadBlocksEx (
                              BlockIo2,
@@ -933,6 +1116,9 @@ DiskIo2ReadWriteDisk (
                              (Subtask->Length % Media->BlockSize == 0) ? Subtask->Length : Media->BlockSize,
                              (Subtask->WorkingBuffer != NULL) ? Subtask->WorkingBuffer : Subtask->Buffer
                              );
+        if (EFI_ERROR (Status)) {
+          DiskIo2CompleteBlockReadSharers (Instance, Subtask, Status);
+        }
       }
     }
 
@@ -43,6 +43,12 @@ typedef struct {
 
   EFI_LOCK                        TaskQueueLock;
   LIST_ENTRY                      TaskQueue;
+  //
+  // Non-blocking partial block reads in flight, protected by TaskQueueLock.
+  // A later non-blocking partial read of the same block waits for one of
+  // them instead of reading the block again.
+  //
+  LIST_ENTRY                      PendingBlockReads;
 } DISK_IO_PRIVATE_DATA;
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO(a)  CR (a, DISK_IO_PRIVATE_DATA, DiskIo,  DISK_IO_PRIVATE_DATA_SIGNATURE)
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO2(a) CR (a, DISK_IO_PRIVATE_DATA, DiskIo2, DISK_IO_PRIVATE_DATA_SIGNATURE)
@@ -86,6 +92,8 @@ typedef struct {
   //
   DISK_IO2_TASK                   *Task;
   EFI_BLOCK_IO2_TOKEN             BlockIo2Token;
+  LIST_ENTRY                      PendingLink;  /// < link to PendingBlockReads or to Sharers of another subtask
+  LIST_ENTRY                      Sharers;      /// < subtasks waiting for the block read by this subtask
 } DISK_IO_SUBTASK;
 
 //
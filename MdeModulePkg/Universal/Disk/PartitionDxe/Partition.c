@@ -640,6 +640,40 @@ ProbeMediaStatus (
   return DefaultStatus;
 }
 
+/**
+  Check whether a request on the partition can be passed to the Block I/O
+  protocol of the parent device as is, instead of going through the Disk I/O
+  protocol of the parent device.
+
+  This is the case when the partition has the same block size as the parent
+  device and the buffer meets the IoAlign requirement of the parent device,
+  which is stricter than the one reported by the partition.
+
+  @param  Private           Pointer to the partition private data.
+  @param  ParentMedia       Media of the parent Block I/O protocol.
+  @param  Buffer            The buffer of the request.
+
+  @retval TRUE              The request can be passed to the parent Block I/O protocol.
+  @retval FALSE             The request has to go through the parent Disk I/O protocol.
+**/
+BOOLEAN
+PartitionIsParentAccessible (
+  IN PARTITION_PRIVATE_DATA  *Private,
+  IN EFI_BLOCK_IO_MEDIA      *ParentMedia,
+  IN VOID                    *Buffer
+  )
+{
+  if (ParentMedia->BlockSize != Private->BlockSize) {
+    return FALSE;
+  }
+
+  if ((ParentMedia->IoAlign > 1) && (((UINTN) Buffer & (ParentMedia->IoAlign - 1)) != 0)) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 /**
   Read by using the Disk IO protocol on the parent device. Lba addresses
   must be converted to byte offsets.
@@ -683,6 +717,20 @@ PartitionReadBlocks (
     return ProbeMediaStatus (Private->DiskIo, MediaId, EFI_INVALID_PARAMETER);
   }
   //
+  // When the partition has the same block size as its parent device, the request
+  // only needs its Lba to be moved to the partition start, so pass it to the
+  // Block IO protocol on the parent device directly.
+  //
+  if (PartitionIsParentAccessible (Private, Private->ParentBlockIo->Media, Buffer)) {
+    return Private->ParentBlockIo->ReadBlocks (
+                                     Private->ParentBlockIo,
+                                     MediaId,
+                                     DivU64x32 (Offset, Private->BlockSize),
+                                     BufferSize,
+                                     Buffer
+                                     );
+  }
+  //
   // Because some kinds of partition have different block size from their parent
   // device, we call the Disk IO protocol on the parent device, not the Block IO
   // protocol
@@ -736,7 +784,9 @@ PartitionWriteBlocks (
   //
   // Because some kinds of partition have different block size from their parent
   // device, we call the Disk IO protocol on the parent device, not the Block IO
-  // protocol
+  // protocol. Unlike reads, writes are never passed to the parent Block IO
+  // protocol directly: the parent Disk IO protocol shares in-flight partial
+  // block reads between requests and has to see every write to the device.
   //
   return Private->DiskIo->WriteDisk (Private->DiskIo, MediaId, Offset, BufferSize, Buffer);
 }
@@ -951,6 +1001,24 @@ PartitionReadBlocksEx (
     return ProbeMediaStatusEx (Private->DiskIo2, MediaId, EFI_INVALID_PARAMETER);
   }
 
+  //
+  // When the partition has the same block size as its parent device, pass the
+  // request and the caller's token to the Block IO2 protocol on the parent device
+  // directly. The parent device signals the token itself, so no access task is
+  // needed.
+  //
+  if ((Token != NULL) &&
+      PartitionIsParentAccessible (Private, Private->ParentBlockIo2->Media, Buffer)) {
+    return Private->ParentBlockIo2->ReadBlocksEx (
+                                      Private->ParentBlockIo2,
+                                      MediaId,
+                                      DivU64x32 (Offset, Private->BlockSize),
+                                      Token,
+                                      BufferSize,
+                                      Buffer
+                                      );
+  }
+
   if ((Token != NULL) && (Token->Event != NULL)) {
     Task = PartitionCreateAccessTask (Token);
     if (Task == NULL) {
@@ -1027,6 +1095,10 @@ PartitionWriteBlocksEx (
     return ProbeMediaStatusEx (Private->DiskIo2, MediaId, EFI_INVALID_PARAMETER);
   }
 
+  //
+  // Writes always go through the Disk IO2 protocol on the parent device, see
+  // PartitionWriteBlocks().
+  //
   if ((Token != NULL) && (Token->Event != NULL)) {
     Task = PartitionCreateAccessTask (Token);
     if (Task == NULL) {
@@ -245,6 +245,8 @@ MnpAddFreeTxBuf (
     DEBUG ((EFI_D_INFO, "MnpAddFreeTxBuf: Add TxBufWrap %p, TxBuf %p\n", TxBufWrap, TxBufWrap->TxBuf));
     TxBufWrap->Signature = MNP_TX_BUF_WRAP_SIGNATURE;
     TxBufWrap->InUse     = FALSE;
+    TxBufWrap->Instance  = NULL;
+    TxBufWrap->Token     = NULL;
     InsertTailList (&MnpDeviceData->FreeTxBufList, &TxBufWrap->WrapEntry);
     InsertTailList (&MnpDeviceData->AllTxBufList, &TxBufWrap->AllEntry);
   }
@@ -371,6 +373,18 @@ MnpFreeTxBuf (
   }
 
   OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  if (TxBufWrap->Token != NULL) {
+    //
+    // The packet was transmitted from the fragments of this token, SNP
+    // doesn't use them any more, so the token is completed now.
+    //
+    TxBufWrap->Token->Status = EFI_SUCCESS;
+    gBS->SignalEvent (TxBufWrap->Token->Event);
+    TxBufWrap->Instance = NULL;
+    TxBufWrap->Token    = NULL;
+    MnpDeviceData->TxPendingCount--;
+  }
+
   InsertTailList (&MnpDeviceData->FreeTxBufList, &TxBufWrap->WrapEntry);
   TxBufWrap->InUse = FALSE;
   gBS->RestoreTPL (OldTpl);
@@ -412,6 +426,180 @@ MnpRecycleTxBuf (
   return EFI_SUCCESS;
 }
 
+/**
+  Check if SNP still holds transmit tokens whose packets are transmitted from
+  their fragments.
+
+  @param[in]  MnpDeviceData     Pointer to the mnp device context data.
+  @param[in]  Instance          Pointer to the mnp instance context data
+                                whose tokens are checked.
+  @param[in]  Token             Pointer to the token to check. If NULL, all
+                                the tokens of Instance are checked.
+
+  @retval TRUE                  At least one of the tokens is still pending.
+  @retval FALSE                 None of the tokens is pending.
+
+**/
+BOOLEAN
+MnpTxTokenPending (
+  IN MNP_DEVICE_DATA                       *MnpDeviceData,
+  IN MNP_INSTANCE_DATA                     *Instance,
+  IN EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token    OPTIONAL
+  )
+{
+  LIST_ENTRY        *Entry;
+  MNP_TX_BUF_WRAP   *TxBufWrap;
+
+  if (MnpDeviceData->TxPendingCount == 0) {
+    return FALSE;
+  }
+
+  NET_LIST_FOR_EACH (Entry, &MnpDeviceData->AllTxBufList) {
+    TxBufWrap = NET_LIST_USER_STRUCT_S (Entry, MNP_TX_BUF_WRAP, AllEntry, MNP_TX_BUF_WRAP_SIGNATURE);
+
+    if ((TxBufWrap->Token != NULL) &&
+        (TxBufWrap->Instance == Instance) &&
+        ((Token == NULL) || (TxBufWrap->Token == Token))) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Wait for SNP to complete the transmit tokens whose packets are transmitted
+  from their fragments.
+
+  These tokens can't be aborted while SNP is running, because the UNDI may
+  still read the fragments of the caller. They are completed by GetStatus()
+  when it recycles the TX buffer holding the media header.
+
+  @param[in, out]  MnpDeviceData     Pointer to the mnp device context data.
+  @param[in]       Instance          Pointer to the mnp instance context data
+                                     whose tokens are waited for.
+  @param[in]       Token             Pointer to the token to wait for. If NULL,
+                                     all the tokens of Instance are waited for.
+
+  @retval EFI_SUCCESS             None of the tokens is pending.
+  @retval EFI_TIMEOUT             SNP didn't complete all the tokens within
+                                  MNP_TX_TIMEOUT_TIME.
+  @retval Others                  SNP failed to recycle the TX buffers.
+
+**/
+EFI_STATUS
+MnpWaitTxTokens (
+  IN OUT MNP_DEVICE_DATA                       *MnpDeviceData,
+  IN     MNP_INSTANCE_DATA                     *Instance,
+  IN     EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token    OPTIONAL
+  )
+{
+  EFI_STATUS        Status;
+  UINTN             Index;
+
+  NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
+
+  //
+  // MNP_TX_TIMEOUT_TIME unit is 100ns, the stall unit is microsecond.
+  //
+  for (Index = 0; Index < MNP_TX_TIMEOUT_TIME / 10 / MNP_TX_RECYCLE_STALL; Index++) {
+    Status = MnpRecycleTxBuf (MnpDeviceData);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (!MnpTxTokenPending (MnpDeviceData, Instance, Token)) {
+      return EFI_SUCCESS;
+    }
+
+    gBS->Stall (MNP_TX_RECYCLE_STALL);
+  }
+
+  DEBUG ((EFI_D_WARN, "MnpWaitTxTokens: SNP didn't complete the transmit tokens of instance %p.\n", Instance));
+  return EFI_TIMEOUT;
+}
+
+/**
+  Detach the transmit tokens of an instance from the TX buffers holding their
+  media header, and complete them with EFI_ABORTED.
+
+  This is used when SNP doesn't complete the tokens in time, so that neither
+  the tokens nor the instance are referenced any more once the instance is
+  reset or destroyed. The TX buffers stay in use until SNP recycles them, as
+  the UNDI may still read them.
+
+  @param[in, out]  MnpDeviceData     Pointer to the mnp device context data.
+  @param[in]       Instance          Pointer to the mnp instance context data
+                                     whose tokens are detached.
+  @param[in]       Token             Pointer to the token to detach. If NULL,
+                                     all the tokens of Instance are detached.
+
+**/
+VOID
+MnpDetachTxTokens (
+  IN OUT MNP_DEVICE_DATA                       *MnpDeviceData,
+  IN     MNP_INSTANCE_DATA                     *Instance,
+  IN     EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token    OPTIONAL
+  )
+{
+  LIST_ENTRY        *Entry;
+  MNP_TX_BUF_WRAP   *TxBufWrap;
+
+  NET_LIST_FOR_EACH (Entry, &MnpDeviceData->AllTxBufList) {
+    TxBufWrap = NET_LIST_USER_STRUCT_S (Entry, MNP_TX_BUF_WRAP, AllEntry, MNP_TX_BUF_WRAP_SIGNATURE);
+
+    if ((TxBufWrap->Token == NULL) ||
+        (TxBufWrap->Instance != Instance) ||
+        ((Token != NULL) && (TxBufWrap->Token != Token))) {
+      continue;
+    }
+
+    //
+    // Leave InUse set, MnpFreeTxBuf() returns the buffer to the free list
+    // once SNP recycles it.
+    //
+    TxBufWrap->Token->Status = EFI_ABORTED;
+    gBS->SignalEvent (TxBufWrap->Token->Event);
+    TxBufWrap->Instance = NULL;
+    TxBufWrap->Token    = NULL;
+    MnpDeviceData->TxPendingCount--;
+  }
+}
+
+/**
+  Abort all the transmit tokens whose packets are transmitted from their
+  fragments and not yet recycled by SNP.
+
+  This must only be called once SNP is shut down. Until then the UNDI may
+  still read the fragments of these packets. The TX buffers holding their
+  media header are not reused.
+
+  @param[in, out]  MnpDeviceData     Pointer to the mnp device context data.
+
+**/
+VOID
+MnpAbortTxTokens (
+  IN OUT MNP_DEVICE_DATA   *MnpDeviceData
+  )
+{
+  LIST_ENTRY        *Entry;
+  MNP_TX_BUF_WRAP   *TxBufWrap;
+
+  NET_LIST_FOR_EACH (Entry, &MnpDeviceData->AllTxBufList) {
+    TxBufWrap = NET_LIST_USER_STRUCT_S (Entry, MNP_TX_BUF_WRAP, AllEntry, MNP_TX_BUF_WRAP_SIGNATURE);
+
+    if (TxBufWrap->Token == NULL) {
+      continue;
+    }
+
+    TxBufWrap->Token->Status = EFI_ABORTED;
+    gBS->SignalEvent (TxBufWrap->Token->Event);
+    TxBufWrap->Instance = NULL;
+    TxBufWrap->Token    = NULL;
+    MnpDeviceData->TxPendingCount--;
+  }
+}
+
 /**
   Initialize the mnp device context data.
 
@@ -465,6 +653,21 @@ MnpInitializeDeviceData (
   SnpMode            = Snp->Mode;
   MnpDeviceData->Snp = Snp;
 
+  //
+  // Use the fragment transmit of SNP if it is provided.
+  //
+  Status = gBS->OpenProtocol (
+                  ControllerHandle,
+                  &gEdkiiSnpFragmentTransmitProtocolGuid,
+                  (VOID **) &MnpDeviceData->SnpFragmentTransmit,
+                  ImageHandle,
+                  ControllerHandle,
+                  EFI_OPEN_PROTOCOL_GET_PROTOCOL
+                  );
+  if (EFI_ERROR (Status)) {
+    MnpDeviceData->SnpFragmentTransmit = NULL;
+  }
+
   //
   // Initialize the lists.
   //
@@ -520,6 +723,8 @@ MnpInitializeDeviceData (
   InitializeListHead (&MnpDeviceData->AllTxBufList);
   MnpDeviceData->TxBufCount = 0;
 
+  InitializeListHead (&MnpDeviceData->FreeRxDataWrapList);
+
   //
   // Create the system poll timer.
   //
@@ -628,9 +833,18 @@ MnpDestroyDeviceData (
   LIST_ENTRY         *Entry;
   LIST_ENTRY         *NextEntry;
   MNP_TX_BUF_WRAP    *TxBufWrap;
+  MNP_RXDATA_WRAP    *RxDataWrap;
 
   NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
 
+  DEBUG (
+    (EFI_D_INFO,
+    "MnpDestroyDeviceData: %ld frames received in %ld polls, at most %d in one poll.\n",
+    MnpDeviceData->RxFrameCount,
+    MnpDeviceData->RxPollCount,
+    MnpDeviceData->RxMaxFramesPerPoll)
+    );
+
   //
   // Free Vlan Config variable name string
   //
@@ -662,6 +876,16 @@ MnpDestroyDeviceData (
   ASSERT (IsListEmpty (&MnpDeviceData->AllTxBufList));
   ASSERT (MnpDeviceData->TxBufCount == 0);
 
+  //
+  // Free the recycled RxDataWraps.
+  //
+  NET_LIST_FOR_EACH_SAFE (Entry, NextEntry, &MnpDeviceData->FreeRxDataWrapList) {
+    RxDataWrap = NET_LIST_USER_STRUCT (Entry, MNP_RXDATA_WRAP, WrapEntry);
+    RemoveEntryList (Entry);
+    gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+    FreePool (RxDataWrap);
+  }
+
   //
   // Free the RxNbufCache.
   //
@@ -1176,6 +1400,12 @@ MnpStopSnp (
   // Shut down the simple network.
   //
   Status  = Snp->Shutdown (Snp);
+
+  //
+  // The packets not transmitted yet are dropped by the shutdown, so the UNDI
+  // no longer reads their fragments.
+  //
+  MnpAbortTxTokens (MnpDeviceData);
   if (!EFI_ERROR (Status)) {
     //
     // Stop the simple network.
@@ -655,6 +655,15 @@ MnpServiceBindingDestroyChild (
 
   gBS->RestoreTPL (OldTpl);
 
+  if (Instance->RcvdPacketDropCount != 0) {
+    DEBUG ((
+      EFI_D_INFO,
+      "MnpServiceBindingDestroyChild: Instance %p dropped %d received packets.\n",
+      Instance,
+      Instance->RcvdPacketDropCount
+      ));
+  }
+
   FreePool (Instance);
 
   return Status;
@@ -20,6 +20,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <Protocol/ManagedNetwork.h>
 #include <Protocol/SimpleNetwork.h>
+#include <Protocol/SnpFragmentTransmit.h>
 #include <Protocol/ServiceBinding.h>
 #include <Protocol/VlanConfig.h>
 
@@ -71,6 +72,13 @@ typedef struct {
   LIST_ENTRY                    AllTxBufList;
   UINT32                        TxBufCount;
 
+  //
+  // Optional SNP extension to transmit the packet from its fragments, and
+  // the number of transmit tokens waiting for SNP to recycle their buffer.
+  //
+  EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL  *SnpFragmentTransmit;
+  UINT32                        TxPendingCount;
+
   NET_BUF_QUEUE                 FreeNbufQue;
   INTN                          NbufCnt;
 
@@ -92,6 +100,18 @@ typedef struct {
   UINT32                        BufferLength;
   UINT32                        PaddingSize;
   NET_BUF                       *RxNbufCache;
+
+  //
+  // The recycled MNP_RXDATA_WRAPs, each keeps its recycle event.
+  //
+  LIST_ENTRY                    FreeRxDataWrapList;
+
+  //
+  // Receive statistics of the poll loop.
+  //
+  UINT64                        RxPollCount;
+  UINT64                        RxFrameCount;
+  UINT32                        RxMaxFramesPerPoll;
 } MNP_DEVICE_DATA;
 
 #define MNP_DEVICE_DATA_FROM_THIS(a) \
@@ -24,13 +24,17 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define MNP_TIMEOUT_CHECK_INTERVAL    (50 * TICKS_PER_MS)   // 50 milliseconds
 #define MNP_MEDIA_DETECT_INTERVAL     (500 * TICKS_PER_MS)  // 500 milliseconds
 #define MNP_TX_TIMEOUT_TIME           (500 * TICKS_PER_MS)  // 500 milliseconds
+#define MNP_TX_RECYCLE_STALL          50                    // 50 microseconds
 #define MNP_INIT_NET_BUFFER_NUM       512
 #define MNP_NET_BUFFER_INCREASEMENT   64
 #define MNP_MAX_NET_BUFFER_NUM        65536
 #define MNP_TX_BUFFER_INCREASEMENT    32    // Same as the recycling Q length for xmit_done in UNDI command.
 #define MNP_MAX_TX_BUFFER_NUM         65536
+#define MNP_MAX_TX_FRAGMENT_NUM       16    // Media header and the fragments of the transmit token.
+#define MNP_TX_FRAGMENT_THRESHOLD     256   // Smaller packets are copied into one TX buffer.
 
 #define MNP_MAX_RCVD_PACKET_QUE_SIZE  256
+#define MNP_RX_POLL_BUDGET            32    // Maximum frames received from Snp in one poll.
 
 #define MNP_RECEIVE_UNICAST           0x01
 #define MNP_RECEIVE_BROADCAST         0x02
@@ -69,6 +73,7 @@ typedef struct {
   LIST_ENTRY                      RxDeliveredPacketQueue;
   LIST_ENTRY                      RcvdPacketQueue;
   UINTN                           RcvdPacketQueueSize;
+  UINT32                          RcvdPacketDropCount;
 
   EFI_MANAGED_NETWORK_CONFIG_DATA ConfigData;
 
@@ -87,7 +92,7 @@ typedef struct {
 } MNP_GROUP_CONTROL_BLOCK;
 
 typedef struct {
-  LIST_ENTRY                        WrapEntry;
+  LIST_ENTRY                        WrapEntry;  // Link to the instance queues or FreeRxDataWrapList
   MNP_INSTANCE_DATA                 *Instance;
   EFI_MANAGED_NETWORK_RECEIVE_DATA  RxData;
   NET_BUF                           *Nbuf;
@@ -101,6 +106,12 @@ typedef struct {
   LIST_ENTRY              WrapEntry;  // Link to FreeTxBufList
   LIST_ENTRY              AllEntry;   // Link to AllTxBufList
   BOOLEAN                 InUse;
+  //
+  // When the packet is transmitted from the fragments of Token, TxBuf only
+  // holds the media header and Token is signaled once SNP recycles TxBuf.
+  //
+  MNP_INSTANCE_DATA                     *Instance;
+  EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token;
   UINT8                   TxBuf[1];
 } MNP_TX_BUF_WRAP;
 
@@ -390,6 +401,43 @@ MnpSyncSendPacket (
   IN OUT EFI_MANAGED_NETWORK_COMPLETION_TOKEN    *Token
   );
 
+/**
+  Check whether the packet of the transmit token can be sent out from its
+  fragments by MnpFragmentSendPacket().
+
+  @param[in]  Instance            Pointer to the mnp instance context data.
+  @param[in]  Token               Pointer to the transmit token.
+
+  @return The packet can be sent out from its fragments or not.
+
+**/
+BOOLEAN
+MnpCanFragmentSend (
+  IN MNP_INSTANCE_DATA                       *Instance,
+  IN EFI_MANAGED_NETWORK_COMPLETION_TOKEN    *Token
+  );
+
+/**
+  Send out the packet from the fragments of the transmit token.
+
+  Only the media header is built in a TX buffer, which is passed to SNP as the
+  first fragment followed by the fragments of the token. The token is signaled
+  when SNP recycles the TX buffer, since SNP uses the fragments until then.
+
+  @param[in]       Instance            Pointer to the mnp instance context data.
+  @param[in, out]  Token               Pointer to the transmit token.
+
+  @retval EFI_SUCCESS                  The packet is placed on the transmit queue,
+                                       or the token is signaled with the error.
+  @retval EFI_OUT_OF_RESOURCES         No TX buffer for the media header.
+
+**/
+EFI_STATUS
+MnpFragmentSendPacket (
+  IN     MNP_INSTANCE_DATA                       *Instance,
+  IN OUT EFI_MANAGED_NETWORK_COMPLETION_TOKEN    *Token
+  );
+
 /**
   Try to deliver the received packet to the instance.
 
@@ -422,11 +470,11 @@ MnpRecycleRxData (
   );
 
 /**
-  Try to receive a packet and deliver it.
+  Try to receive up to MNP_RX_POLL_BUDGET packets and deliver them.
 
   @param[in, out]  MnpDeviceData        Pointer to the mnp device context data.
 
-  @retval EFI_SUCCESS           add return value to function comment
+  @retval EFI_SUCCESS           At least one packet is received.
   @retval EFI_NOT_STARTED       The simple network protocol is not started.
   @retval EFI_NOT_READY         No packet received.
   @retval EFI_DEVICE_ERROR      An unexpected error occurs.
@@ -482,6 +530,19 @@ MnpAllocTxBuf (
   IN OUT MNP_DEVICE_DATA   *MnpDeviceData
   );
 
+/**
+  Try to reclaim the TX buffer into the buffer pool.
+
+  @param[in, out]  MnpDeviceData         Pointer to the mnp device context data.
+  @param[in, out]  TxBuf                 Pointer to the TX buffer to free.
+
+**/
+VOID
+MnpFreeTxBuf (
+  IN OUT MNP_DEVICE_DATA   *MnpDeviceData,
+  IN OUT UINT8             *TxBuf
+  );
+
 /**
   Try to recycle all the transmitted buffer address from SNP.
 
@@ -496,6 +557,93 @@ MnpRecycleTxBuf (
   IN OUT MNP_DEVICE_DATA   *MnpDeviceData
   );
 
+/**
+  Check if SNP still holds transmit tokens whose packets are transmitted from
+  their fragments.
+
+  @param[in]  MnpDeviceData     Pointer to the mnp device context data.
+  @param[in]  Instance          Pointer to the mnp instance context data
+                                whose tokens are checked.
+  @param[in]  Token             Pointer to the token to check. If NULL, all
+                                the tokens of Instance are checked.
+
+  @retval TRUE                  At least one of the tokens is still pending.
+  @retval FALSE                 None of the tokens is pending.
+
+**/
+BOOLEAN
+MnpTxTokenPending (
+  IN MNP_DEVICE_DATA                       *MnpDeviceData,
+  IN MNP_INSTANCE_DATA                     *Instance,
+  IN EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token    OPTIONAL
+  );
+
+/**
+  Wait for SNP to complete the transmit tokens whose packets are transmitted
+  from their fragments.
+
+  These tokens can't be aborted while SNP is running, because the UNDI may
+  still read the fragments of the caller. They are completed by GetStatus()
+  when it recycles the TX buffer holding the media header.
+
+  @param[in, out]  MnpDeviceData     Pointer to the mnp device context data.
+  @param[in]       Instance          Pointer to the mnp instance context data
+                                     whose tokens are waited for.
+  @param[in]       Token             Pointer to the token to wait for. If NULL,
+                                     all the tokens of Instance are waited for.
+
+  @retval EFI_SUCCESS             None of the tokens is pending.
+  @retval EFI_TIMEOUT             SNP didn't complete all the tokens within
+                                  MNP_TX_TIMEOUT_TIME.
+  @retval Others                  SNP failed to recycle the TX buffers.
+
+**/
+EFI_STATUS
+MnpWaitTxTokens (
+  IN OUT MNP_DEVICE_DATA                       *MnpDeviceData,
+  IN     MNP_INSTANCE_DATA                     *Instance,
+  IN     EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token    OPTIONAL
+  );
+
+/**
+  Detach the transmit tokens of an instance from the TX buffers holding their
+  media header, and complete them with EFI_ABORTED.
+
+  This is used when SNP doesn't complete the tokens in time, so that neither
+  the tokens nor the instance are referenced any more once the instance is
+  reset or destroyed. The TX buffers stay in use until SNP recycles them, as
+  the UNDI may still read them.
+
+  @param[in, out]  MnpDeviceData     Pointer to the mnp device context data.
+  @param[in]       Instance          Pointer to the mnp instance context data
+                                     whose tokens are detached.
+  @param[in]       Token             Pointer to the token to detach. If NULL,
+                                     all the tokens of Instance are detached.
+
+**/
+VOID
+MnpDetachTxTokens (
+  IN OUT MNP_DEVICE_DATA                       *MnpDeviceData,
+  IN     MNP_INSTANCE_DATA                     *Instance,
+  IN     EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token    OPTIONAL
+  );
+
+/**
+  Abort all the transmit tokens whose packets are transmitted from their
+  fragments and not yet recycled by SNP.
+
+  This must only be called once SNP is shut down. Until then the UNDI may
+  still read the fragments of these packets. The TX buffers holding their
+  media header are not reused.
+
+  @param[in, out]  MnpDeviceData     Pointer to the mnp device context data.
+
+**/
+VOID
+MnpAbortTxTokens (
+  IN OUT MNP_DEVICE_DATA   *MnpDeviceData
+  );
+
 /**
   Remove the received packets if timeout occurs.
 
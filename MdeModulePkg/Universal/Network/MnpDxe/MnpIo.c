@@ -302,6 +302,190 @@ SIGNAL_TOKEN:
 }
 
 
+/**
+  Check whether the packet of the transmit token can be sent out from its
+  fragments by MnpFragmentSendPacket().
+
+  @param[in]  Instance            Pointer to the mnp instance context data.
+  @param[in]  Token               Pointer to the transmit token.
+
+  @return The packet can be sent out from its fragments or not.
+
+**/
+BOOLEAN
+MnpCanFragmentSend (
+  IN MNP_INSTANCE_DATA                       *Instance,
+  IN EFI_MANAGED_NETWORK_COMPLETION_TOKEN    *Token
+  )
+{
+  MNP_DEVICE_DATA                       *MnpDeviceData;
+  EFI_MANAGED_NETWORK_TRANSMIT_DATA     *TxData;
+  UINT32                                MaxFragmentCount;
+
+  MnpDeviceData = Instance->MnpServiceData->MnpDeviceData;
+  TxData        = Token->Packet.TxData;
+
+  if (MnpDeviceData->SnpFragmentTransmit == NULL) {
+    return FALSE;
+  }
+
+  //
+  // The media header is built by MNP in its own TX buffer, so it must not be
+  // part of the fragments. Small packets are cheaper to copy than to keep the
+  // token pending until SNP recycles the buffer.
+  //
+  if ((TxData->DestinationAddress == NULL) || (TxData->DataLength < MNP_TX_FRAGMENT_THRESHOLD)) {
+    return FALSE;
+  }
+
+  MaxFragmentCount = MIN (MNP_MAX_TX_FRAGMENT_NUM, MnpDeviceData->SnpFragmentTransmit->MaxFragmentCount);
+
+  return (BOOLEAN) (TxData->FragmentCount < MaxFragmentCount);
+}
+
+
+/**
+  Send out the packet from the fragments of the transmit token.
+
+  Only the media header is built in a TX buffer, which is passed to SNP as the
+  first fragment followed by the fragments of the token. The token is signaled
+  when SNP recycles the TX buffer, since SNP uses the fragments until then.
+
+  @param[in]       Instance            Pointer to the mnp instance context data.
+  @param[in, out]  Token               Pointer to the transmit token.
+
+  @retval EFI_SUCCESS                  The packet is placed on the transmit queue,
+                                       or the token is signaled with the error.
+  @retval EFI_OUT_OF_RESOURCES         No TX buffer for the media header.
+
+**/
+EFI_STATUS
+MnpFragmentSendPacket (
+  IN     MNP_INSTANCE_DATA                       *Instance,
+  IN OUT EFI_MANAGED_NETWORK_COMPLETION_TOKEN    *Token
+  )
+{
+  EFI_STATUS                            Status;
+  MNP_SERVICE_DATA                      *MnpServiceData;
+  MNP_DEVICE_DATA                       *MnpDeviceData;
+  EFI_SIMPLE_NETWORK_MODE               *SnpMode;
+  EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL  *SnpFragmentTransmit;
+  EFI_MANAGED_NETWORK_TRANSMIT_DATA     *TxData;
+  EDKII_SNP_FRAGMENT_DATA               FragmentTable[MNP_MAX_TX_FRAGMENT_NUM];
+  MNP_TX_BUF_WRAP                       *TxBufWrap;
+  UINT8                                 *TxBuf;
+  UINT8                                 *Packet;
+  UINT32                                Length;
+  UINT16                                ProtocolType;
+  UINT32                                Index;
+
+  MnpServiceData      = Instance->MnpServiceData;
+  MnpDeviceData       = MnpServiceData->MnpDeviceData;
+  SnpMode             = MnpDeviceData->Snp->Mode;
+  SnpFragmentTransmit = MnpDeviceData->SnpFragmentTransmit;
+  TxData              = Token->Packet.TxData;
+  Token->Status       = EFI_SUCCESS;
+
+  //
+  // Check media status before transmit packet.
+  // Note: media status will be updated by periodic timer MediaDetectTimer.
+  //
+  if (SnpMode->MediaPresentSupported && !SnpMode->MediaPresent) {
+    //
+    // Media not present, skip packet transmit and report EFI_NO_MEDIA
+    //
+    DEBUG ((EFI_D_WARN, "MnpFragmentSendPacket: No network cable detected.\n"));
+    Token->Status = EFI_NO_MEDIA;
+    goto SIGNAL_TOKEN;
+  }
+
+  TxBuf = MnpAllocTxBuf (MnpDeviceData);
+  if (TxBuf == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // The TX buffer only holds the media header to be filled in by SNP, plus
+  // the vlan tag if needed.
+  //
+  Length = SnpMode->MediaHeaderSize;
+  if (MnpServiceData->VlanId != 0) {
+    Packet = TxBuf + NET_VLAN_TAG_LEN;
+    MnpInsertVlanTag (MnpServiceData, TxData, &ProtocolType, &Packet, &Length);
+  } else {
+    Packet       = TxBuf;
+    ProtocolType = TxData->ProtocolType;
+  }
+
+  FragmentTable[0].FragmentLength = Length;
+  FragmentTable[0].FragmentBuffer = Packet;
+  for (Index = 0; Index < TxData->FragmentCount; Index++) {
+    FragmentTable[Index + 1].FragmentLength = TxData->FragmentTable[Index].FragmentLength;
+    FragmentTable[Index + 1].FragmentBuffer = TxData->FragmentTable[Index].FragmentBuffer;
+  }
+
+  //
+  // The token is completed by MnpFreeTxBuf() when SNP recycles the TX buffer.
+  //
+  TxBufWrap           = NET_LIST_USER_STRUCT (TxBuf, MNP_TX_BUF_WRAP, TxBuf);
+  TxBufWrap->Instance = Instance;
+  TxBufWrap->Token    = Token;
+  MnpDeviceData->TxPendingCount++;
+
+  //
+  // Transmit the packet through SNP.
+  //
+  Status = SnpFragmentTransmit->TransmitFragments (
+                                  SnpFragmentTransmit,
+                                  SnpMode->MediaHeaderSize,
+                                  TxData->FragmentCount + 1,
+                                  FragmentTable,
+                                  TxData->SourceAddress,
+                                  TxData->DestinationAddress,
+                                  &ProtocolType
+                                  );
+  if (Status == EFI_NOT_READY) {
+    Status = MnpRecycleTxBuf (MnpDeviceData);
+    if (!EFI_ERROR (Status)) {
+      Status = SnpFragmentTransmit->TransmitFragments (
+                                      SnpFragmentTransmit,
+                                      SnpMode->MediaHeaderSize,
+                                      TxData->FragmentCount + 1,
+                                      FragmentTable,
+                                      TxData->SourceAddress,
+                                      TxData->DestinationAddress,
+                                      &ProtocolType
+                                      );
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // SNP doesn't take the packet, complete the token with the error now.
+  //
+  TxBufWrap->Instance = NULL;
+  TxBufWrap->Token    = NULL;
+  MnpDeviceData->TxPendingCount--;
+  MnpFreeTxBuf (MnpDeviceData, TxBuf);
+
+  Token->Status = EFI_DEVICE_ERROR;
+
+SIGNAL_TOKEN:
+
+  gBS->SignalEvent (Token->Event);
+
+  //
+  // Dispatch the DPC queued by the NotifyFunction of Token->Event.
+  //
+  DispatchDpc ();
+
+  return EFI_SUCCESS;
+}
+
+
 /**
   Try to deliver the received packet to the instance.
 
@@ -459,16 +643,11 @@ MnpRecycleRxData (
   RxDataWrap->Nbuf = NULL;
 
   //
-  // Close the recycle event.
-  //
-  gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
-
-  //
-  // Remove this Wrap entry from the list.
+  // Remove this Wrap entry from the list, and keep it together with its
+  // recycle event for the next received packet.
   //
   RemoveEntryList (&RxDataWrap->WrapEntry);
-
-  FreePool (RxDataWrap);
+  InsertTailList (&MnpDeviceData->FreeRxDataWrapList, &RxDataWrap->WrapEntry);
 }
 
 
@@ -511,6 +690,7 @@ MnpQueueRcvdPacket (
     //
     MnpRecycleRxData (NULL, (VOID *) OldRxDataWrap);
     Instance->RcvdPacketQueueSize--;
+    Instance->RcvdPacketDropCount++;
   }
 
   //
@@ -724,7 +904,34 @@ MnpWrapRxData (
   )
 {
   EFI_STATUS      Status;
+  MNP_DEVICE_DATA *MnpDeviceData;
   MNP_RXDATA_WRAP *RxDataWrap;
+  EFI_EVENT       RecycleEvent;
+  EFI_TPL         OldTpl;
+
+  MnpDeviceData = Instance->MnpServiceData->MnpDeviceData;
+
+  //
+  // Reuse a recycled wrap if there is one. The recycle event runs at
+  // TPL_NOTIFY, so raise the TPL to take the wrap from the free list.
+  //
+  RxDataWrap = NULL;
+  OldTpl     = gBS->RaiseTPL (TPL_NOTIFY);
+  if (!IsListEmpty (&MnpDeviceData->FreeRxDataWrapList)) {
+    RxDataWrap = NET_LIST_HEAD (&MnpDeviceData->FreeRxDataWrapList, MNP_RXDATA_WRAP, WrapEntry);
+    RemoveEntryList (&RxDataWrap->WrapEntry);
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  if (RxDataWrap != NULL) {
+    RxDataWrap->Instance = Instance;
+
+    RecycleEvent = RxDataWrap->RxData.RecycleEvent;
+    CopyMem (&RxDataWrap->RxData, RxData, sizeof (RxDataWrap->RxData));
+    RxDataWrap->RxData.RecycleEvent = RecycleEvent;
+
+    return RxDataWrap;
+  }
 
   //
   // Allocate memory.
@@ -820,6 +1027,7 @@ MnpEnqueuePacket (
       //
       RxDataWrap = MnpWrapRxData (Instance, &RxData);
       if (RxDataWrap == NULL) {
+        Instance->RcvdPacketDropCount++;
         continue;
       }
 
@@ -839,19 +1047,21 @@ MnpEnqueuePacket (
 
 
 /**
-  Try to receive a packet and deliver it.
+  Try to receive a packet and queue it to the matched instances.
 
   @param[in, out]  MnpDeviceData        Pointer to the mnp device context data.
+  @param[out]      Queued               Set to TRUE if the packet is queued to
+                                        at least one instance.
 
-  @retval EFI_SUCCESS           add return value to function comment
-  @retval EFI_NOT_STARTED       The simple network protocol is not started.
+  @retval EFI_SUCCESS           One packet is received.
   @retval EFI_NOT_READY         No packet received.
   @retval EFI_DEVICE_ERROR      An unexpected error occurs.
 
 **/
 EFI_STATUS
-MnpReceivePacket (
-  IN OUT MNP_DEVICE_DATA   *MnpDeviceData
+MnpReceiveFrame (
+  IN OUT MNP_DEVICE_DATA   *MnpDeviceData,
+     OUT BOOLEAN           *Queued
   )
 {
   EFI_STATUS                  Status;
@@ -865,15 +1075,9 @@ MnpReceivePacket (
   UINT16                      VlanId;
   BOOLEAN                     IsVlanPacket;
 
-  NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
+  *Queued = FALSE;
 
   Snp = MnpDeviceData->Snp;
-  if (Snp->Mode->State != EfiSimpleNetworkInitialized) {
-    //
-    // The simple network protocol is not started.
-    //
-    return EFI_NOT_STARTED;
-  }
 
   if (MnpDeviceData->RxNbufCache == NULL) {
     //
@@ -972,6 +1176,7 @@ MnpReceivePacket (
     // RefCnt > 2 indicates there is at least one receiver of this packet.
     // Free the current RxNbufCache and allocate a new one.
     //
+    *Queued = TRUE;
     MnpFreeNbuf (MnpDeviceData, Nbuf);
 
     Nbuf                       = MnpAllocNbuf (MnpDeviceData);
@@ -995,10 +1200,6 @@ MnpReceivePacket (
 
     goto EXIT;
   }
-  //
-  // Deliver the queued packets.
-  //
-  MnpDeliverPacket (MnpServiceData);
 
 EXIT:
 
@@ -1008,6 +1209,77 @@ EXIT:
 }
 
 
+/**
+  Try to receive up to MNP_RX_POLL_BUDGET packets and deliver them.
+
+  The packets are drained from the Snp receive queue first, then delivered
+  to the instances once for the whole batch.
+
+  @param[in, out]  MnpDeviceData        Pointer to the mnp device context data.
+
+  @retval EFI_SUCCESS           At least one packet is received.
+  @retval EFI_NOT_STARTED       The simple network protocol is not started.
+  @retval EFI_NOT_READY         No packet received.
+  @retval EFI_DEVICE_ERROR      An unexpected error occurs.
+
+**/
+EFI_STATUS
+MnpReceivePacket (
+  IN OUT MNP_DEVICE_DATA   *MnpDeviceData
+  )
+{
+  EFI_STATUS                  Status;
+  LIST_ENTRY                  *Entry;
+  UINT32                      Frames;
+  BOOLEAN                     Queued;
+  BOOLEAN                     Deliver;
+
+  NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
+
+  if (MnpDeviceData->Snp->Mode->State != EfiSimpleNetworkInitialized) {
+    //
+    // The simple network protocol is not started.
+    //
+    return EFI_NOT_STARTED;
+  }
+
+  if (MnpDeviceData->TxPendingCount != 0) {
+    //
+    // Complete the transmit tokens whose packets have been sent out from
+    // their fragments.
+    //
+    MnpRecycleTxBuf (MnpDeviceData);
+  }
+
+  Status  = EFI_SUCCESS;
+  Deliver = FALSE;
+  for (Frames = 0; Frames < MNP_RX_POLL_BUDGET; Frames++) {
+    Status  = MnpReceiveFrame (MnpDeviceData, &Queued);
+    Deliver = (BOOLEAN) (Deliver || Queued);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  if (Deliver) {
+    //
+    // Deliver the queued packets.
+    //
+    NET_LIST_FOR_EACH (Entry, &MnpDeviceData->ServiceList) {
+      MnpDeliverPacket (MNP_SERVICE_DATA_FROM_LINK (Entry));
+    }
+  }
+
+  MnpDeviceData->RxPollCount++;
+  MnpDeviceData->RxFrameCount += Frames;
+  if (Frames > MnpDeviceData->RxMaxFramesPerPoll) {
+    MnpDeviceData->RxMaxFramesPerPoll = Frames;
+  }
+
+  return (Frames != 0) ? EFI_SUCCESS : Status;
+}
+
+
 /**
   Remove the received packets if timeout occurs.
 
@@ -1035,6 +1307,15 @@ MnpCheckPacketTimeout (
   MnpDeviceData = (MNP_DEVICE_DATA *) Context;
   NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
 
+  if (MnpDeviceData->TxPendingCount != 0) {
+    //
+    // The system poll may be disabled, make sure the transmit tokens pending
+    // on SNP are completed.
+    //
+    MnpRecycleTxBuf (MnpDeviceData);
+    DispatchDpc ();
+  }
+
   NET_LIST_FOR_EACH (ServiceEntry, &MnpDeviceData->ServiceList) {
     MnpServiceData = MNP_SERVICE_DATA_FROM_LINK (ServiceEntry);
 
@@ -1069,6 +1350,7 @@ MnpCheckPacketTimeout (
           DEBUG ((EFI_D_WARN, "MnpCheckPacketTimeout: Received packet timeout.\n"));
           MnpRecycleRxData (NULL, RxDataWrap);
           Instance->RcvdPacketQueueSize--;
+          Instance->RcvdPacketDropCount++;
         }
       }
 
@@ -549,6 +549,14 @@ MnpTransmit (
   MnpServiceData = Instance->MnpServiceData;
   NET_CHECK_SIGNATURE (MnpServiceData, MNP_SERVICE_DATA_SIGNATURE);
 
+  if (MnpCanFragmentSend (Instance, Token)) {
+    //
+    // Send the packet from its fragments without copying them.
+    //
+    Status = MnpFragmentSendPacket (Instance, Token);
+    goto ON_EXIT;
+  }
+
   //
   // Build the tx packet
   //
@@ -696,6 +704,7 @@ MnpCancel (
 {
   EFI_STATUS         Status;
   MNP_INSTANCE_DATA  *Instance;
+  MNP_DEVICE_DATA    *MnpDeviceData;
   EFI_TPL            OldTpl;
 
   if (This == NULL) {
@@ -719,6 +728,26 @@ MnpCancel (
     Status = (Status == EFI_ABORTED) ? EFI_SUCCESS : EFI_NOT_FOUND;
   }
 
+  MnpDeviceData = Instance->MnpServiceData->MnpDeviceData;
+  if ((MnpDeviceData->TxPendingCount != 0) && ((Token == NULL) || (Status == EFI_NOT_FOUND))) {
+    //
+    // The transmit tokens already handed to SNP can't be aborted, as the UNDI
+    // may still read their fragments. Wait for SNP to complete them instead,
+    // a token completed this way is not found in the transmit queue.
+    //
+    // If SNP doesn't complete them, detach them from their TX buffers, so that
+    // they are not completed after the instance is reset or destroyed. The TX
+    // buffers are not reused until SNP recycles them.
+    //
+    if (EFI_ERROR (MnpWaitTxTokens (MnpDeviceData, Instance, Token)) &&
+        MnpTxTokenPending (MnpDeviceData, Instance, Token)) {
+      MnpDetachTxTokens (MnpDeviceData, Instance, Token);
+      if (Token != NULL) {
+        Status = EFI_SUCCESS;
+      }
+    }
+  }
+
   //
   // Dispatch the DPC queued by the NotifyFunction of the cancled token's events.
   //
@@ -588,6 +588,11 @@ SimpleNetworkDriverStart (
     Snp->Mode.MultipleTxSupported = FALSE;
   }
 
+  if ((Pxe->hw.Implementation & PXE_ROMID_IMP_FRAG_SUPPORTED) != 0) {
+    Snp->FragmentTransmit.MaxFragmentCount  = MAX_XMIT_FRAGMENTS;
+    Snp->FragmentTransmit.TransmitFragments = SnpUndi32TransmitFragments;
+  }
+
   Snp->Mode.ReceiveFilterMask = EFI_SIMPLE_NETWORK_RECEIVE_UNICAST;
 
   if ((Pxe->hw.Implementation & PXE_ROMID_IMP_PROMISCUOUS_MULTICAST_RX_SUPPORTED) != 0) {
@@ -679,7 +684,22 @@ SimpleNetworkDriverStart (
                   );
 
   if (!EFI_ERROR (Status)) {
-    return Status;
+    if (Snp->FragmentTransmit.TransmitFragments != NULL) {
+      //
+      // The fragment transmit is optional, SNP works without it.
+      //
+      Status = gBS->InstallProtocolInterface (
+                      &Controller,
+                      &gEdkiiSnpFragmentTransmitProtocolGuid,
+                      EFI_NATIVE_INTERFACE,
+                      &Snp->FragmentTransmit
+                      );
+      if (EFI_ERROR (Status)) {
+        Snp->FragmentTransmit.TransmitFragments = NULL;
+      }
+    }
+
+    return EFI_SUCCESS;
   }
 
   PciIo->FreeBuffer (
@@ -774,6 +794,17 @@ SimpleNetworkDriverStop (
 
   Snp = EFI_SIMPLE_NETWORK_DEV_FROM_THIS (SnpProtocol);
 
+  if (Snp->FragmentTransmit.TransmitFragments != NULL) {
+    Status = gBS->UninstallProtocolInterface (
+                    Controller,
+                    &gEdkiiSnpFragmentTransmitProtocolGuid,
+                    &Snp->FragmentTransmit
+                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   Status = gBS->UninstallProtocolInterface (
                   Controller,
                   &gEfiSimpleNetworkProtocolGuid,
@@ -781,6 +812,15 @@ SimpleNetworkDriverStop (
                   );
 
   if (EFI_ERROR (Status)) {
+    if (Snp->FragmentTransmit.TransmitFragments != NULL) {
+      gBS->InstallProtocolInterface (
+             &Controller,
+             &gEdkiiSnpFragmentTransmitProtocolGuid,
+             EFI_NATIVE_INTERFACE,
+             &Snp->FragmentTransmit
+             );
+    }
+
     return Status;
   }
 
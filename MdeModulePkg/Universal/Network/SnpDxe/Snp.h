@@ -18,6 +18,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Uefi.h>
 
 #include <Protocol/SimpleNetwork.h>
+#include <Protocol/SnpFragmentTransmit.h>
 #include <Protocol/PciIo.h>
 #include <Protocol/NetworkInterfaceIdentifier.h>
 #include <Protocol/DevicePath.h>
@@ -65,6 +66,11 @@ typedef struct {
   EFI_SIMPLE_NETWORK_PROTOCOL Snp;
   EFI_SIMPLE_NETWORK_MODE     Mode;
 
+  //
+  // Only installed when UNDI supports fragmented transmit.
+  //
+  EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL  FragmentTransmit;
+
   EFI_HANDLE                  DeviceHandle;
   EFI_DEVICE_PATH_PROTOCOL    *DevicePath;
 
@@ -157,6 +163,7 @@ typedef struct {
 } SNP_DRIVER;
 
 #define EFI_SIMPLE_NETWORK_DEV_FROM_THIS(a) CR (a, SNP_DRIVER, Snp, SNP_DRIVER_SIGNATURE)
+#define SNP_DRIVER_FROM_FRAGMENT_TRANSMIT(a) CR (a, SNP_DRIVER, FragmentTransmit, SNP_DRIVER_SIGNATURE)
 
 //
 // Global Variables
@@ -959,6 +966,48 @@ SnpUndi32Transmit (
   IN UINT16                      *Protocol  OPTIONAL
   );
 
+/**
+  Places a packet described by a list of fragments in the transmit queue of
+  a network interface.
+
+  The first fragment holds the media header. When the packet has been
+  transmitted, the buffer of the first fragment is returned as the recycled
+  transmit buffer by GetStatus().
+
+  @param This          A pointer to the EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL instance.
+  @param HeaderSize    The size, in bytes, of the media header to be filled in.
+                       If HeaderSize is nonzero, then it must be equal to
+                       Mode->MediaHeaderSize and the DestAddr and Protocol
+                       parameters must not be NULL.
+  @param FragmentCount The number of fragments in FragmentTable.
+  @param FragmentTable The fragments of the packet, media header first.
+  @param SrcAddr       The source HW MAC address. If HeaderSize is nonzero and
+                       SrcAddr is NULL, then Mode->CurrentAddress is used.
+  @param DestAddr      The destination HW MAC address.
+  @param Protocol      The type of header to build.
+
+  @retval EFI_SUCCESS           The packet was placed on the transmit queue.
+  @retval EFI_NOT_STARTED       The network interface has not been started.
+  @retval EFI_NOT_READY         The network interface is too busy to accept this
+                                transmit request.
+  @retval EFI_BUFFER_TOO_SMALL  The first fragment is too small for the media header.
+  @retval EFI_INVALID_PARAMETER One or more of the parameters has an unsupported
+                                value.
+  @retval EFI_DEVICE_ERROR      The command could not be sent to the network interface.
+
+**/
+EFI_STATUS
+EFIAPI
+SnpUndi32TransmitFragments (
+  IN EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL *This,
+  IN UINTN                                HeaderSize,
+  IN UINT32                               FragmentCount,
+  IN EDKII_SNP_FRAGMENT_DATA              *FragmentTable,
+  IN EFI_MAC_ADDRESS                      *SrcAddr,  OPTIONAL
+  IN EFI_MAC_ADDRESS                      *DestAddr, OPTIONAL
+  IN UINT16                               *Protocol  OPTIONAL
+  );
+
 /**
   Receives a packet from a network interface.
 
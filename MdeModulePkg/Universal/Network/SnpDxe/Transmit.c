@@ -219,6 +219,93 @@ PxeTransmit (
   return Status;
 }
 
+/**
+  This routine calls undi to transmit the given list of fragments
+
+  @param  Snp              pointer to SNP driver structure
+  @param  FragmentCount    number of fragments in FragmentTable
+  @param  FragmentTable    fragments of the frame, media header first
+  @param  FrameLen         size of the whole frame
+
+  @retval EFI_SUCCESS         if successfully completed the undi call
+  @retval Other               error return from undi call.
+
+**/
+EFI_STATUS
+PxeTransmitFragments (
+  SNP_DRIVER              *Snp,
+  UINT32                  FragmentCount,
+  EDKII_SNP_FRAGMENT_DATA *FragmentTable,
+  UINTN                   FrameLen
+  )
+{
+  PXE_CPB_TRANSMIT_FRAGMENTS  *Cpb;
+  EFI_STATUS                  Status;
+  UINT32                      Index;
+
+  Cpb                 = Snp->Cpb;
+  Cpb->FrameLen       = (UINT32) FrameLen;
+  Cpb->MediaheaderLen = 0;
+  Cpb->FragCnt        = (UINT16) FragmentCount;
+
+  for (Index = 0; Index < FragmentCount; Index++) {
+    Cpb->FragDesc[Index].FragAddr = (UINT64) (UINTN) FragmentTable[Index].FragmentBuffer;
+    Cpb->FragDesc[Index].FragLen  = FragmentTable[Index].FragmentLength;
+    Cpb->FragDesc[Index].reserved = 0;
+  }
+
+  Snp->Cdb.OpFlags    = PXE_OPFLAGS_TRANSMIT_FRAGMENTED;
+
+  Snp->Cdb.CPBsize    = (UINT16) sizeof (PXE_CPB_TRANSMIT_FRAGMENTS);
+  Snp->Cdb.CPBaddr    = (UINT64)(UINTN) Cpb;
+
+  Snp->Cdb.OpCode     = PXE_OPCODE_TRANSMIT;
+  Snp->Cdb.DBsize     = PXE_DBSIZE_NOT_USED;
+  Snp->Cdb.DBaddr     = PXE_DBADDR_NOT_USED;
+
+  Snp->Cdb.StatCode   = PXE_STATCODE_INITIALIZE;
+  Snp->Cdb.StatFlags  = PXE_STATFLAGS_INITIALIZE;
+  Snp->Cdb.IFnum      = Snp->IfNum;
+  Snp->Cdb.Control    = PXE_CONTROL_LAST_CDB_IN_LIST;
+
+  //
+  // Issue UNDI command and check result.
+  //
+  DEBUG ((EFI_D_NET, "\nSnp->undi.transmit()  fragmented, %d fragments", FragmentCount));
+
+  (*Snp->IssueUndi32Command) ((UINT64) (UINTN) &Snp->Cdb);
+
+  DEBUG ((EFI_D_NET, "\nexit Snp->undi.transmit()  "));
+
+  switch (Snp->Cdb.StatCode) {
+  case PXE_STATCODE_SUCCESS:
+    return EFI_SUCCESS;
+
+  case PXE_STATCODE_BUFFER_FULL:
+  case PXE_STATCODE_QUEUE_FULL:
+  case PXE_STATCODE_BUSY:
+    Status = EFI_NOT_READY;
+    DEBUG (
+      (EFI_D_NET,
+      "\nSnp->undi.transmit()  %xh:%xh\n",
+      Snp->Cdb.StatFlags,
+      Snp->Cdb.StatCode)
+      );
+    break;
+
+  default:
+    DEBUG (
+      (EFI_D_ERROR,
+      "\nSnp->undi.transmit()  %xh:%xh\n",
+      Snp->Cdb.StatFlags,
+      Snp->Cdb.StatCode)
+      );
+    Status = EFI_DEVICE_ERROR;
+  }
+
+  return Status;
+}
+
 /**
   Places a packet in the transmit queue of a network interface.
 
@@ -357,3 +444,127 @@ ON_EXIT:
 
   return Status;
 }
+
+/**
+  Places a packet described by a list of fragments in the transmit queue of
+  a network interface.
+
+  The first fragment holds the media header. When the packet has been
+  transmitted, the buffer of the first fragment is returned as the recycled
+  transmit buffer by GetStatus().
+
+  @param This          A pointer to the EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL instance.
+  @param HeaderSize    The size, in bytes, of the media header to be filled in.
+                       If HeaderSize is nonzero, then it must be equal to
+                       Mode->MediaHeaderSize and the DestAddr and Protocol
+                       parameters must not be NULL.
+  @param FragmentCount The number of fragments in FragmentTable.
+  @param FragmentTable The fragments of the packet, media header first.
+  @param SrcAddr       The source HW MAC address. If HeaderSize is nonzero and
+                       SrcAddr is NULL, then Mode->CurrentAddress is used.
+  @param DestAddr      The destination HW MAC address.
+  @param Protocol      The type of header to build.
+
+  @retval EFI_SUCCESS           The packet was placed on the transmit queue.
+  @retval EFI_NOT_STARTED       The network interface has not been started.
+  @retval EFI_NOT_READY         The network interface is too busy to accept this
+                                transmit request.
+  @retval EFI_BUFFER_TOO_SMALL  The first fragment is too small for the media header.
+  @retval EFI_INVALID_PARAMETER One or more of the parameters has an unsupported
+                                value.
+  @retval EFI_DEVICE_ERROR      The command could not be sent to the network interface.
+
+**/
+EFI_STATUS
+EFIAPI
+SnpUndi32TransmitFragments (
+  IN EDKII_SNP_FRAGMENT_TRANSMIT_PROTOCOL *This,
+  IN UINTN                                HeaderSize,
+  IN UINT32                               FragmentCount,
+  IN EDKII_SNP_FRAGMENT_DATA              *FragmentTable,
+  IN EFI_MAC_ADDRESS                      *SrcAddr,  OPTIONAL
+  IN EFI_MAC_ADDRESS                      *DestAddr, OPTIONAL
+  IN UINT16                               *Protocol  OPTIONAL
+  )
+{
+  SNP_DRIVER  *Snp;
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+  UINTN       FrameLen;
+  UINT32      Index;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Snp = SNP_DRIVER_FROM_FRAGMENT_TRANSMIT (This);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  switch (Snp->Mode.State) {
+  case EfiSimpleNetworkInitialized:
+    break;
+
+  case EfiSimpleNetworkStopped:
+    Status = EFI_NOT_STARTED;
+    goto ON_EXIT;
+
+  default:
+    Status = EFI_DEVICE_ERROR;
+    goto ON_EXIT;
+  }
+
+  if ((FragmentTable == NULL) || (FragmentCount == 0) || (FragmentCount > MAX_XMIT_FRAGMENTS)) {
+    Status = EFI_INVALID_PARAMETER;
+    goto ON_EXIT;
+  }
+
+  FrameLen = 0;
+  for (Index = 0; Index < FragmentCount; Index++) {
+    if (FragmentTable[Index].FragmentBuffer == NULL) {
+      Status = EFI_INVALID_PARAMETER;
+      goto ON_EXIT;
+    }
+
+    FrameLen += FragmentTable[Index].FragmentLength;
+  }
+
+  if (FragmentTable[0].FragmentLength < Snp->Mode.MediaHeaderSize) {
+    Status = EFI_BUFFER_TOO_SMALL;
+    goto ON_EXIT;
+  }
+
+  //
+  // if the HeaderSize is non-zero, we need to fill up the header in the
+  // first fragment, and for that we need the destination address and the
+  // protocol
+  //
+  if (HeaderSize != 0) {
+    if (HeaderSize != Snp->Mode.MediaHeaderSize || DestAddr == 0 || Protocol == 0) {
+      Status = EFI_INVALID_PARAMETER;
+      goto ON_EXIT;
+    }
+
+    Status = PxeFillHeader (
+              Snp,
+              FragmentTable[0].FragmentBuffer,
+              HeaderSize,
+              (UINT8 *) FragmentTable[0].FragmentBuffer + HeaderSize,
+              FrameLen - HeaderSize,
+              DestAddr,
+              SrcAddr,
+              Protocol
+              );
+
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+  }
+
+  Status = PxeTransmitFragments (Snp, FragmentCount, FragmentTable, FrameLen);
+
+ON_EXIT:
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
+}
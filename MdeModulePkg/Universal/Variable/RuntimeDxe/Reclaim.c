@@ -98,6 +98,12 @@ GetLbaAndOffsetByAddress (
   volume block device. The destination is specified by parameter
   VariableBase. Fault Tolerant Write protocol is used for writing.
 
+  Reclaim keeps the variables in store order, so the head of the store up to
+  the first removed variable is usually unchanged. Only the part of the store
+  from the first block that differs up to the end of the store is written,
+  which keeps the spare block backup a valid image of the high part of the NV
+  storage as expected by InitNonVolatileVariableStore() after a power loss.
+
   @param  VariableBase   Base address of variable to write
   @param  VariableBuffer Point to the variable data buffer.
 
@@ -118,6 +124,11 @@ FtwVariableSpace (
   UINTN                              VarOffset;
   UINTN                              FtwBufferSize;
   EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *FtwProtocol;
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL *Fvb;
+  UINTN                              BlockSize;
+  UINTN                              NumberOfBlocks;
+  UINTN                              WriteOffset;
+  UINTN                              CompareSize;
 
   //
   // Locate fault tolerant write protocol.
@@ -129,32 +140,70 @@ FtwVariableSpace (
   //
   // Locate Fvb handle by address.
   //
-  Status = GetFvbInfoByAddress (VariableBase, &FvbHandle, NULL);
+  Status = GetFvbInfoByAddress (VariableBase, &FvbHandle, &Fvb);
   if (EFI_ERROR (Status)) {
     return Status;
   }
+
+  FtwBufferSize = ((VARIABLE_STORE_HEADER *) ((UINTN) VariableBase))->Size;
+  ASSERT (FtwBufferSize == VariableBuffer->Size);
+
   //
-  // Get LBA and Offset by address.
+  // Skip the leading blocks that already hold the new content. As in
+  // GetLbaAndOffsetByAddress(), all blocks are assumed to have the same size.
   //
   Status = GetLbaAndOffsetByAddress (VariableBase, &VarLba, &VarOffset);
   if (EFI_ERROR (Status)) {
     return EFI_ABORTED;
   }
+  Status = Fvb->GetBlockSize (Fvb, VarLba, &BlockSize, &NumberOfBlocks);
+  if (EFI_ERROR (Status) || (BlockSize <= VarOffset)) {
+    return EFI_ABORTED;
+  }
+  WriteOffset = 0;
+  CompareSize = BlockSize - VarOffset;
+  while (WriteOffset < FtwBufferSize) {
+    CompareSize = MIN (CompareSize, FtwBufferSize - WriteOffset);
+    if (CompareMem (
+          (UINT8 *) (UINTN) VariableBase + WriteOffset,
+          (UINT8 *) VariableBuffer + WriteOffset,
+          CompareSize
+          ) != 0) {
+      break;
+    }
+    WriteOffset += CompareSize;
+    CompareSize  = BlockSize;
+  }
+  if (WriteOffset == FtwBufferSize) {
+    //
+    // Nothing to write.
+    //
+    return EFI_SUCCESS;
+  }
 
-  FtwBufferSize = ((VARIABLE_STORE_HEADER *) ((UINTN) VariableBase))->Size;
-  ASSERT (FtwBufferSize == VariableBuffer->Size);
+  //
+  // Get LBA and Offset by address.
+  //
+  Status = GetLbaAndOffsetByAddress (VariableBase + WriteOffset, &VarLba, &VarOffset);
+  if (EFI_ERROR (Status)) {
+    return EFI_ABORTED;
+  }
+
+  if (WriteOffset != 0) {
+    DEBUG ((DEBUG_INFO, "Variable: Reclaim writes 0x%x of 0x%x bytes\n", FtwBufferSize - WriteOffset, FtwBufferSize));
+  }
 
   //
   // FTW write record.
   //
   Status = FtwProtocol->Write (
                           FtwProtocol,
-                          VarLba,         // LBA
-                          VarOffset,      // Offset
-                          FtwBufferSize,  // NumBytes
-                          NULL,           // PrivateData NULL
-                          FvbHandle,      // Fvb Handle
-                          (VOID *) VariableBuffer // write buffer
+                          VarLba,                                   // LBA
+                          VarOffset,                                // Offset
+                          FtwBufferSize - WriteOffset,              // NumBytes
+                          NULL,                                     // PrivateData NULL
+                          FvbHandle,                                // Fvb Handle
+                          (UINT8 *) VariableBuffer + WriteOffset    // write buffer
                           );
 
   return Status;
@@ -1211,6 +1211,11 @@ Done:
     CopyMem (mNvVariableCache, (UINT8 *)(UINTN)VariableBase, VariableStoreHeader->Size);
   }
 
+  //
+  // The variables have been moved, the hash index is rebuilt on next lookup.
+  //
+  VariableIndexInvalidate (IsVolatile ? VariableStoreTypeVolatile : VariableStoreTypeNv);
+
   return Status;
 }
 
@@ -1236,9 +1241,20 @@ FindVariableEx (
 {
   VARIABLE_HEADER                *InDeletedVariable;
   VOID                           *Point;
+  EFI_STATUS                     Status;
 
   PtrTrack->InDeletedTransitionPtr = NULL;
 
+  //
+  // Use the hash index of the store when there is one.
+  //
+  if (VariableName[0] != 0) {
+    Status = VariableIndexFind (VariableName, VendorGuid, IgnoreRtCheck, PtrTrack);
+    if (Status != EFI_UNSUPPORTED) {
+      return Status;
+    }
+  }
+
   //
   // Find the variable by walk through HOB, volatile and non-volatile variable store.
   //
@@ -3086,6 +3102,125 @@ VariableServiceGetNextVariableName (
   return Status;
 }
 
+/**
+  Update or delete an existing volatile variable without going through
+  UpdateVariable().
+
+  The volatile store is plain memory that is only ever appended to, with old
+  copies marked deleted and the space given back by Reclaim(). A plain boot
+  services variable that already lives there therefore does not need the
+  scratch buffer, the FVB/FTW plumbing, the HOB flush or the authenticated
+  variable processing UpdateVariable() and AuthVariableLib go through: a same
+  size update is done in place, any other update appends the new copy at the
+  end of the store and marks the old one deleted.
+
+  Only variables that carry no attribute other than EFI_VARIABLE_BOOTSERVICE_ACCESS
+  and EFI_VARIABLE_RUNTIME_ACCESS, both in the request and in the store, and
+  that are not in the EFI global variable namespace (whose Lang/PlatformLang
+  and secure boot variables need the extra processing) are handled here.
+  Everything else, as well as an update that does not fit in the free space,
+  is left to UpdateVariable().
+
+  The caller must hold the variable services lock and must have already done
+  the attribute checks of VariableServiceSetVariable().
+
+  @param[in]      VariableName       Name of variable.
+  @param[in]      VendorGuid         Guid of variable.
+  @param[in]      Data               Variable data.
+  @param[in]      DataSize           Size of data. 0 means delete.
+  @param[in]      Attributes         Attributes of the variable.
+  @param[in, out] Variable           The variable information which is used
+                                     to keep track of variable usage.
+
+  @retval EFI_SUCCESS                The variable was updated or deleted.
+  @retval EFI_UNSUPPORTED            The request must go through UpdateVariable().
+
+**/
+STATIC
+EFI_STATUS
+UpdateVolatileVariable (
+  IN      CHAR16                      *VariableName,
+  IN      EFI_GUID                    *VendorGuid,
+  IN      VOID                        *Data,
+  IN      UINTN                       DataSize,
+  IN      UINT32                      Attributes,
+  IN OUT  VARIABLE_POINTER_TRACK      *Variable
+  )
+{
+  VARIABLE_STORE_HEADER               *VariableStoreHeader;
+  VARIABLE_HEADER                     *NextVariable;
+  UINTN                               VarNameSize;
+  UINTN                               VarDataOffset;
+  UINTN                               VarSize;
+
+  if (AtRuntime () ||
+      (Variable->CurrPtr == NULL) ||
+      !Variable->Volatile ||
+      (Variable->InDeletedTransitionPtr != NULL) ||
+      (Variable->CurrPtr->State != VAR_ADDED)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (((Attributes & ~(EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)) != 0) ||
+      ((Variable->CurrPtr->Attributes & ~(EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)) != 0) ||
+      CompareGuid (VendorGuid, &gEfiGlobalVariableGuid)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Setting a data variable with no access, or zero DataSize attributes
+  // causes it to be deleted.
+  //
+  if ((DataSize == 0) || ((Attributes & (EFI_VARIABLE_RUNTIME_ACCESS | EFI_VARIABLE_BOOTSERVICE_ACCESS)) == 0)) {
+    Variable->CurrPtr->State &= VAR_DELETED;
+    UpdateVariableInfo (VariableName, VendorGuid, TRUE, FALSE, FALSE, TRUE, FALSE);
+    return EFI_SUCCESS;
+  }
+
+  if (DataSizeOfVariable (Variable->CurrPtr) == DataSize) {
+    //
+    // The record keeps its size, so the data can simply be overwritten.
+    //
+    if (CompareMem (Data, GetVariableDataPtr (Variable->CurrPtr), DataSize) != 0) {
+      CopyMem (GetVariableDataPtr (Variable->CurrPtr), Data, DataSize);
+    }
+    UpdateVariableInfo (VariableName, VendorGuid, TRUE, FALSE, TRUE, FALSE, FALSE);
+    return EFI_SUCCESS;
+  }
+
+  VariableStoreHeader = (VARIABLE_STORE_HEADER *) ((UINTN) mVariableModuleGlobal->VariableGlobal.VolatileVariableBase);
+  VarNameSize         = NameSizeOfVariable (Variable->CurrPtr);
+  VarDataOffset       = GetVariableDataOffset (Variable->CurrPtr);
+  VarSize             = VarDataOffset + DataSize + GET_PAD_SIZE (DataSize);
+  if ((UINT32) (VarSize + mVariableModuleGlobal->VolatileLastVariableOffset) > VariableStoreHeader->Size) {
+    //
+    // Let UpdateVariable() reclaim the volatile store.
+    //
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Append the new copy behind the last variable. The header and the name are
+  // taken over from the old copy, the new copy only becomes valid once it is
+  // completely written, and the old copy is deleted last.
+  //
+  NextVariable = (VARIABLE_HEADER *) ((UINTN) VariableStoreHeader + mVariableModuleGlobal->VolatileLastVariableOffset);
+  SetMem (NextVariable, VarSize, 0xff);
+  CopyMem (NextVariable, Variable->CurrPtr, GetVariableHeaderSize () + VarNameSize);
+  NextVariable->State = VAR_HEADER_VALID_ONLY;
+  CopyMem ((UINT8 *) ((UINTN) NextVariable + VarDataOffset), Data, DataSize);
+  SetDataSizeOfVariable (NextVariable, DataSize);
+  NextVariable->State = VAR_ADDED;
+
+  mVariableModuleGlobal->VolatileLastVariableOffset += HEADER_ALIGN (VarSize);
+
+  Variable->CurrPtr->State &= VAR_DELETED;
+  Variable->CurrPtr = NextVariable;
+
+  UpdateVariableInfo (VariableName, VendorGuid, TRUE, FALSE, TRUE, FALSE, FALSE);
+  return EFI_SUCCESS;
+}
+
 /**
 
   This code sets variable in storage blocks (Volatile or Non-Volatile).
@@ -3304,6 +3439,14 @@ VariableServiceSetVariable (
       DEBUG ((EFI_D_INFO, "[Variable]: Rewritten a preexisting variable(0x%08x) with different attributes(0x%08x) - %g:%s\n", Variable.CurrPtr->Attributes, Attributes, VendorGuid, VariableName));
       goto Done;
     }
+
+    //
+    // Plain volatile variables that already exist skip the generic update path.
+    //
+    Status = UpdateVolatileVariable (VariableName, VendorGuid, Data, DataSize, Attributes, &Variable);
+    if (Status != EFI_UNSUPPORTED) {
+      goto Done;
+    }
   }
 
   if (!FeaturePcdGet (PcdUefiVariableDefaultLangDeprecate)) {
@@ -4358,6 +4501,13 @@ VariableCommonInitialize (
   VolatileVariableStore->Reserved    = 0;
   VolatileVariableStore->Reserved1   = 0;
 
+  //
+  // Allocate the hash indexes used by FindVariableEx(). Without an index the
+  // store is searched linearly, so a failure here is not fatal.
+  //
+  VariableIndexInitialize (VariableStoreTypeVolatile, VolatileVariableStore);
+  VariableIndexInitialize (VariableStoreTypeNv, mNvVariableCache);
+
   return EFI_SUCCESS;
 }
 
@@ -79,6 +79,46 @@ typedef struct {
   BOOLEAN         Volatile;
 } VARIABLE_POINTER_TRACK;
 
+///
+/// Marks the end of a hash chain in VARIABLE_INDEX.
+///
+#define VARIABLE_INDEX_END      MAX_UINT32
+
+///
+/// One variable header known to VARIABLE_INDEX.
+///
+typedef struct {
+  UINT32          Offset;     ///< Offset of the header from the first variable of the store.
+  UINT32          Next;       ///< Next entry in the same hash chain, or VARIABLE_INDEX_END.
+} VARIABLE_INDEX_ENTRY;
+
+typedef struct {
+  UINT64          Lookups;
+  UINT64          Hits;
+  UINT64          Probes;
+  UINT32          MaxProbeLength;
+  UINT32          Rebuilds;
+} VARIABLE_INDEX_STATISTICS;
+
+///
+/// Hash index of the variable headers in one variable store, keyed by name and
+/// vendor GUID. Headers are only ever appended to a store between two reclaims,
+/// so the index is brought up to date by indexing the headers that follow
+/// IndexedEnd. Entries for headers that have since been deleted are skipped
+/// on lookup and dropped when the store is reclaimed.
+///
+typedef struct {
+  UINT32                      *Buckets;
+  VARIABLE_INDEX_ENTRY        *Entries;
+  UINT32                      BucketMask;
+  UINT32                      EntryCapacity;
+  UINT32                      EntryCount;
+  UINT32                      IndexedEnd;
+  BOOLEAN                     Valid;
+  BOOLEAN                     Overflow;
+  VARIABLE_INDEX_STATISTICS   Statistics;
+} VARIABLE_INDEX;
+
 typedef struct {
   EFI_PHYSICAL_ADDRESS  HobVariableBase;
   EFI_PHYSICAL_ADDRESS  VolatileVariableBase;
@@ -108,6 +148,7 @@ typedef struct {
   CHAR8           *PlatformLang;
   CHAR8           Lang[ISO_639_2_ENTRY_SIZE + 1];
   EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL *FvbInstance;
+  VARIABLE_INDEX  VariableIndex[VariableStoreTypeMax];
 } VARIABLE_MODULE_GLOBAL;
 
 /**
@@ -792,6 +833,135 @@ InitializeVariableQuota (
   VOID
   );
 
+/**
+
+  This code checks if variable header is valid or not.
+
+  @param Variable           Pointer to the Variable Header.
+  @param VariableStoreEnd   Pointer to the Variable Store End.
+
+  @retval TRUE              Variable header is valid.
+  @retval FALSE             Variable header is not valid.
+
+**/
+BOOLEAN
+IsValidVariableHeader (
+  IN  VARIABLE_HEADER       *Variable,
+  IN  VARIABLE_HEADER       *VariableStoreEnd
+  );
+
+/**
+
+  This code gets the size of name of variable.
+
+  @param Variable        Pointer to the Variable Header.
+
+  @return UINTN          Size of variable in bytes.
+
+**/
+UINTN
+NameSizeOfVariable (
+  IN  VARIABLE_HEADER   *Variable
+  );
+
+/**
+
+  This code gets the pointer to the next variable header.
+
+  @param Variable        Pointer to the Variable Header.
+
+  @return Pointer to next variable header.
+
+**/
+VARIABLE_HEADER *
+GetNextVariablePtr (
+  IN  VARIABLE_HEADER   *Variable
+  );
+
+/**
+
+  Gets the pointer to the first variable header in given variable store area.
+
+  @param VarStoreHeader  Pointer to the Variable Store Header.
+
+  @return Pointer to the first variable header.
+
+**/
+VARIABLE_HEADER *
+GetStartPointer (
+  IN VARIABLE_STORE_HEADER       *VarStoreHeader
+  );
+
+/**
+  Allocate the hash index of a variable store.
+
+  The index is sized for the largest number of variable headers the store can
+  hold, so that it never needs to grow at runtime.
+
+  @param[in] Type               Type of the variable store.
+  @param[in] VarStoreHeader     Pointer to the variable store header.
+
+  @retval EFI_SUCCESS           The index was allocated.
+  @retval EFI_OUT_OF_RESOURCES  No enough memory for the index. Lookups in this
+                                store fall back to a linear search.
+
+**/
+EFI_STATUS
+VariableIndexInitialize (
+  IN VARIABLE_STORE_TYPE        Type,
+  IN VARIABLE_STORE_HEADER      *VarStoreHeader
+  );
+
+/**
+  Discard the content of the hash index of a variable store. The index is
+  rebuilt on the next lookup.
+
+  This must be called whenever the variable headers of the store are moved,
+  as done by Reclaim().
+
+  @param[in] Type               Type of the variable store.
+
+**/
+VOID
+VariableIndexInvalidate (
+  IN VARIABLE_STORE_TYPE        Type
+  );
+
+/**
+  Find a variable through the hash index of the store selected by
+  PtrTrack->StartPtr.
+
+  The result is the same as the one of the linear search in FindVariableEx().
+
+  @param[in]       VariableName        Name of the variable to be found, must not be empty.
+  @param[in]       VendorGuid          Vendor GUID to be found.
+  @param[in]       IgnoreRtCheck       Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                       check at runtime when searching variable.
+  @param[in, out]  PtrTrack            Variable Track Pointer structure that contains Variable Information.
+
+  @retval EFI_SUCCESS                  Variable found successfully.
+  @retval EFI_NOT_FOUND                Variable not found.
+  @retval EFI_UNSUPPORTED              The store has no usable index, the caller
+                                       must search the store linearly.
+
+**/
+EFI_STATUS
+VariableIndexFind (
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN     BOOLEAN                 IgnoreRtCheck,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack
+  );
+
+/**
+  Print the hash index statistics of all variable stores.
+
+**/
+VOID
+VariableIndexDumpStatistics (
+  VOID
+  );
+
 extern VARIABLE_MODULE_GLOBAL  *mVariableModuleGlobal;
 
 extern AUTH_VAR_LIB_CONTEXT_OUT mAuthContextOut;
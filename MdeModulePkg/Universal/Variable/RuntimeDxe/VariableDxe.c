@@ -254,6 +254,10 @@ VariableClassAddressChangeEvent (
   EfiConvertPointer (0x0, (VOID **) &mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase);
   EfiConvertPointer (0x0, (VOID **) &mVariableModuleGlobal->VariableGlobal.VolatileVariableBase);
   EfiConvertPointer (0x0, (VOID **) &mVariableModuleGlobal->VariableGlobal.HobVariableBase);
+  for (Index = 0; Index < VariableStoreTypeMax; Index++) {
+    EfiConvertPointer (0x0, (VOID **) &mVariableModuleGlobal->VariableIndex[Index].Buckets);
+    EfiConvertPointer (0x0, (VOID **) &mVariableModuleGlobal->VariableIndex[Index].Entries);
+  }
   EfiConvertPointer (0x0, (VOID **) &mVariableModuleGlobal);
   EfiConvertPointer (0x0, (VOID **) &mNvVariableCache);
   EfiConvertPointer (0x0, (VOID **) &mNvFvHeaderCache);
@@ -304,6 +308,7 @@ OnReadyToBoot (
   }
   ReclaimForOS ();
   if (FeaturePcdGet (PcdVariableCollectStatistics)) {
+    VariableIndexDumpStatistics ();
     if (mVariableModuleGlobal->VariableGlobal.AuthFormat) {
       gBS->InstallConfigurationTable (&gEfiAuthenticatedVariableGuid, gVariableInfo);
     } else {
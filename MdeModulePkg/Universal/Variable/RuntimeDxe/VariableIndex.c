@@ -0,0 +1,381 @@
+/** @file
+  Hash index of the variable headers in the volatile and non-volatile
+  variable stores, used to speed up FindVariableEx().
+
+  Caution: This module requires additional review when modified.
+  This driver will have external input - variable data. They may be input in SMM mode.
+  The index only caches offsets of headers; every candidate is checked against
+  the variable store content exactly as the linear search does.
+
+Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "Variable.h"
+
+#define VARIABLE_INDEX_MIN_BUCKETS   16
+
+extern VARIABLE_STORE_HEADER         *mNvVariableCache;
+
+/**
+  Get the hash index of the variable store whose first variable is StartPtr.
+
+  @param[in] StartPtr           Pointer to the first variable of the store.
+
+  @return Pointer to the index, or NULL if the store has no index.
+
+**/
+STATIC
+VARIABLE_INDEX *
+GetVariableIndexByStartPtr (
+  IN VARIABLE_HEADER            *StartPtr
+  )
+{
+  VARIABLE_STORE_HEADER         *VolatileStore;
+
+  if ((mNvVariableCache != NULL) && (StartPtr == GetStartPointer (mNvVariableCache))) {
+    return &mVariableModuleGlobal->VariableIndex[VariableStoreTypeNv];
+  }
+
+  VolatileStore = (VARIABLE_STORE_HEADER *) (UINTN) mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
+  if ((VolatileStore != NULL) && (StartPtr == GetStartPointer (VolatileStore))) {
+    return &mVariableModuleGlobal->VariableIndex[VariableStoreTypeVolatile];
+  }
+
+  return NULL;
+}
+
+/**
+  Compute the hash of a variable name and vendor GUID.
+
+  The name is hashed up to its NULL terminator, or up to NameSize bytes if
+  there is no terminator before.
+
+  @param[in] Name               Pointer to the variable name.
+  @param[in] NameSize           Maximum size of the name in bytes.
+  @param[in] Guid               Pointer to the vendor GUID.
+
+  @return The 32-bit FNV-1a hash of the name characters and GUID bytes.
+
+**/
+STATIC
+UINT32
+VariableIndexHash (
+  IN CONST CHAR16               *Name,
+  IN UINTN                      NameSize,
+  IN CONST EFI_GUID             *Guid
+  )
+{
+  UINT32                        Hash;
+  UINTN                         Index;
+  CONST UINT8                   *GuidBytes;
+
+  Hash = 0x811C9DC5;
+  for (Index = 0; (Index < NameSize / sizeof (CHAR16)) && (Name[Index] != 0); Index++) {
+    Hash = (Hash ^ Name[Index]) * 0x01000193;
+  }
+
+  GuidBytes = (CONST UINT8 *) Guid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Hash = (Hash ^ GuidBytes[Index]) * 0x01000193;
+  }
+
+  return Hash;
+}
+
+/**
+  Add the variable headers appended to the store since the last call to the
+  index. The index is rebuilt from the start of the store if it was
+  invalidated.
+
+  @param[in, out] VariableIndex Pointer to the index of the store.
+  @param[in]      StartPtr      Pointer to the first variable of the store.
+  @param[in]      EndPtr        Pointer to the end of the store.
+
+  @retval TRUE                  The index covers all variables of the store.
+  @retval FALSE                 The store cannot be indexed until it is reclaimed.
+
+**/
+STATIC
+BOOLEAN
+VariableIndexSync (
+  IN OUT VARIABLE_INDEX         *VariableIndex,
+  IN     VARIABLE_HEADER        *StartPtr,
+  IN     VARIABLE_HEADER        *EndPtr
+  )
+{
+  VARIABLE_HEADER               *Variable;
+  VARIABLE_INDEX_ENTRY          *Entry;
+  CHAR16                        *Name;
+  UINTN                         NameSize;
+  UINT32                        Slot;
+
+  if (VariableIndex->Overflow) {
+    return FALSE;
+  }
+
+  if (!VariableIndex->Valid) {
+    SetMem (VariableIndex->Buckets, (VariableIndex->BucketMask + 1) * sizeof (UINT32), 0xff);
+    VariableIndex->EntryCount = 0;
+    VariableIndex->IndexedEnd = 0;
+    VariableIndex->Valid      = TRUE;
+    VariableIndex->Statistics.Rebuilds++;
+  }
+
+  Variable = (VARIABLE_HEADER *) ((UINTN) StartPtr + VariableIndex->IndexedEnd);
+  while (IsValidVariableHeader (Variable, EndPtr)) {
+    //
+    // A name without NULL terminator would be matched by FindVariableEx()
+    // as a prefix of a longer name, which a hash cannot reproduce.
+    //
+    Name     = GetVariableNamePtr (Variable);
+    NameSize = NameSizeOfVariable (Variable);
+    if ((VariableIndex->EntryCount == VariableIndex->EntryCapacity) ||
+        (NameSize < sizeof (CHAR16)) ||
+        (Name[NameSize / sizeof (CHAR16) - 1] != 0)) {
+      DEBUG ((DEBUG_WARN, "Variable: index disabled until next reclaim\n"));
+      VariableIndex->Overflow = TRUE;
+      return FALSE;
+    }
+
+    Slot  = VariableIndexHash (Name, NameSize, GetVendorGuidPtr (Variable)) & VariableIndex->BucketMask;
+    Entry = &VariableIndex->Entries[VariableIndex->EntryCount];
+    Entry->Offset = (UINT32) ((UINTN) Variable - (UINTN) StartPtr);
+    Entry->Next   = VariableIndex->Buckets[Slot];
+    VariableIndex->Buckets[Slot] = VariableIndex->EntryCount;
+    VariableIndex->EntryCount++;
+
+    Variable = GetNextVariablePtr (Variable);
+  }
+  VariableIndex->IndexedEnd = (UINT32) ((UINTN) Variable - (UINTN) StartPtr);
+
+  return TRUE;
+}
+
+/**
+  Allocate the hash index of a variable store.
+
+  The index is sized for the largest number of variable headers the store can
+  hold, so that it never needs to grow at runtime.
+
+  @param[in] Type               Type of the variable store.
+  @param[in] VarStoreHeader     Pointer to the variable store header.
+
+  @retval EFI_SUCCESS           The index was allocated.
+  @retval EFI_OUT_OF_RESOURCES  No enough memory for the index. Lookups in this
+                                store fall back to a linear search.
+
+**/
+EFI_STATUS
+VariableIndexInitialize (
+  IN VARIABLE_STORE_TYPE        Type,
+  IN VARIABLE_STORE_HEADER      *VarStoreHeader
+  )
+{
+  VARIABLE_INDEX                *VariableIndex;
+  UINTN                         Capacity;
+  UINT32                        BucketCount;
+
+  VariableIndex = &mVariableModuleGlobal->VariableIndex[Type];
+  ZeroMem (VariableIndex, sizeof (VARIABLE_INDEX));
+
+  //
+  // The smallest variable is a header with a one character (NULL) name.
+  //
+  Capacity    = (VarStoreHeader->Size - sizeof (VARIABLE_STORE_HEADER)) /
+                HEADER_ALIGN (sizeof (VARIABLE_HEADER) + sizeof (CHAR16)) + 1;
+  BucketCount = MAX (GetPowerOfTwo32 ((UINT32) (Capacity / 4)), VARIABLE_INDEX_MIN_BUCKETS);
+
+  VariableIndex->Buckets = AllocateRuntimePool (BucketCount * sizeof (UINT32));
+  VariableIndex->Entries = AllocateRuntimePool (Capacity * sizeof (VARIABLE_INDEX_ENTRY));
+  if ((VariableIndex->Buckets == NULL) || (VariableIndex->Entries == NULL)) {
+    if (VariableIndex->Buckets != NULL) {
+      FreePool (VariableIndex->Buckets);
+    }
+    if (VariableIndex->Entries != NULL) {
+      FreePool (VariableIndex->Entries);
+    }
+    VariableIndex->Buckets = NULL;
+    VariableIndex->Entries = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  VariableIndex->BucketMask    = BucketCount - 1;
+  VariableIndex->EntryCapacity = (UINT32) Capacity;
+  VariableIndex->Valid         = FALSE;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Discard the content of the hash index of a variable store. The index is
+  rebuilt on the next lookup.
+
+  This must be called whenever the variable headers of the store are moved,
+  as done by Reclaim().
+
+  @param[in] Type               Type of the variable store.
+
+**/
+VOID
+VariableIndexInvalidate (
+  IN VARIABLE_STORE_TYPE        Type
+  )
+{
+  mVariableModuleGlobal->VariableIndex[Type].Valid    = FALSE;
+  mVariableModuleGlobal->VariableIndex[Type].Overflow = FALSE;
+}
+
+/**
+  Find a variable through the hash index of the store selected by
+  PtrTrack->StartPtr.
+
+  The result is the same as the one of the linear search in FindVariableEx().
+
+  @param[in]       VariableName        Name of the variable to be found, must not be empty.
+  @param[in]       VendorGuid          Vendor GUID to be found.
+  @param[in]       IgnoreRtCheck       Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                       check at runtime when searching variable.
+  @param[in, out]  PtrTrack            Variable Track Pointer structure that contains Variable Information.
+
+  @retval EFI_SUCCESS                  Variable found successfully.
+  @retval EFI_NOT_FOUND                Variable not found.
+  @retval EFI_UNSUPPORTED              The store has no usable index, the caller
+                                       must search the store linearly.
+
+**/
+EFI_STATUS
+VariableIndexFind (
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN     BOOLEAN                 IgnoreRtCheck,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack
+  )
+{
+  VARIABLE_INDEX                 *VariableIndex;
+  VARIABLE_HEADER                *Variable;
+  VARIABLE_HEADER                *AddedVariable;
+  VARIABLE_HEADER                *InDeletedVariable;
+  UINT32                         EntryIndex;
+  UINT32                         Slot;
+  UINT32                         ProbeLength;
+  BOOLEAN                        Pass;
+
+  ASSERT (VariableName[0] != 0);
+
+  VariableIndex = GetVariableIndexByStartPtr (PtrTrack->StartPtr);
+  if ((VariableIndex == NULL) || (VariableIndex->Entries == NULL) ||
+      !VariableIndexSync (VariableIndex, PtrTrack->StartPtr, PtrTrack->EndPtr)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  VariableIndex->Statistics.Lookups++;
+
+  Slot = VariableIndexHash (VariableName, MAX_UINTN, VendorGuid) & VariableIndex->BucketMask;
+
+  //
+  // FindVariableEx() returns the first ADDED variable of the store, together
+  // with the last IN_DELETED_TRANSITION one before it. Without ADDED variable,
+  // it returns the last IN_DELETED_TRANSITION one. The chain is in reverse
+  // insertion order, so locate the ADDED variable in the first pass and the
+  // IN_DELETED_TRANSITION variable in the second.
+  //
+  AddedVariable     = NULL;
+  InDeletedVariable = NULL;
+  ProbeLength       = 0;
+  for (Pass = FALSE; ; Pass = TRUE) {
+    for (EntryIndex = VariableIndex->Buckets[Slot];
+         EntryIndex != VARIABLE_INDEX_END;
+         EntryIndex = VariableIndex->Entries[EntryIndex].Next) {
+      if (!Pass) {
+        ProbeLength++;
+      }
+      Variable = (VARIABLE_HEADER *) ((UINTN) PtrTrack->StartPtr + VariableIndex->Entries[EntryIndex].Offset);
+      if ((Variable->State != VAR_ADDED) &&
+          (Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+        continue;
+      }
+      if ((Variable->State == VAR_ADDED) == Pass) {
+        continue;
+      }
+      if (!IgnoreRtCheck && AtRuntime () && ((Variable->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)) {
+        continue;
+      }
+      if (!CompareGuid (VendorGuid, GetVendorGuidPtr (Variable)) ||
+          (CompareMem (VariableName, GetVariableNamePtr (Variable), NameSizeOfVariable (Variable)) != 0)) {
+        continue;
+      }
+
+      if (!Pass) {
+        if ((AddedVariable == NULL) || (Variable < AddedVariable)) {
+          AddedVariable = Variable;
+        }
+      } else if ((AddedVariable == NULL) || (Variable < AddedVariable)) {
+        if ((InDeletedVariable == NULL) || (Variable > InDeletedVariable)) {
+          InDeletedVariable = Variable;
+        }
+      }
+    }
+    if (Pass) {
+      break;
+    }
+  }
+
+  VariableIndex->Statistics.Probes += ProbeLength;
+  if (ProbeLength > VariableIndex->Statistics.MaxProbeLength) {
+    VariableIndex->Statistics.MaxProbeLength = ProbeLength;
+  }
+
+  if (AddedVariable != NULL) {
+    PtrTrack->CurrPtr                = AddedVariable;
+    PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
+  } else {
+    PtrTrack->CurrPtr                = InDeletedVariable;
+    PtrTrack->InDeletedTransitionPtr = NULL;
+  }
+
+  if (PtrTrack->CurrPtr == NULL) {
+    return EFI_NOT_FOUND;
+  }
+  VariableIndex->Statistics.Hits++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Print the hash index statistics of all variable stores.
+
+**/
+VOID
+VariableIndexDumpStatistics (
+  VOID
+  )
+{
+  VARIABLE_STORE_TYPE           Type;
+  VARIABLE_INDEX                *VariableIndex;
+
+  for (Type = (VARIABLE_STORE_TYPE) 0; Type < VariableStoreTypeMax; Type++) {
+    VariableIndex = &mVariableModuleGlobal->VariableIndex[Type];
+    if (VariableIndex->Entries == NULL) {
+      continue;
+    }
+    DEBUG ((
+      DEBUG_INFO,
+      "Variable: index %d - entries %d/%d, lookups %ld, hits %ld, probes %ld, max probe %d, rebuilds %d\n",
+      Type,
+      VariableIndex->EntryCount,
+      VariableIndex->EntryCapacity,
+      VariableIndex->Statistics.Lookups,
+      VariableIndex->Statistics.Hits,
+      VariableIndex->Statistics.Probes,
+      VariableIndex->Statistics.MaxProbeLength,
+      VariableIndex->Statistics.Rebuilds
+      ));
+  }
+}
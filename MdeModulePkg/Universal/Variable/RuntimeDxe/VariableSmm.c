@@ -700,6 +700,9 @@ SmmVariableHandler (
         InitializeVariableQuota ();
       }
       ReclaimForOS ();
+      if (FeaturePcdGet (PcdVariableCollectStatistics)) {
+        VariableIndexDumpStatistics ();
+      }
       Status = EFI_SUCCESS;
       break;
 
@@ -1098,7 +1098,7 @@ HttpConfigureTcp4 (
   IP4_COPY_ADDRESS (&Tcp4AP->RemoteAddress, &HttpInstance->RemoteAddr);
 
   Tcp4Option = Tcp4CfgData->ControlOption;
-  Tcp4Option->ReceiveBufferSize      = HTTP_BUFFER_SIZE_DEAULT;
+  Tcp4Option->ReceiveBufferSize      = PcdGet32 (PcdHttpReceiveBufferSize);
   Tcp4Option->SendBufferSize         = HTTP_BUFFER_SIZE_DEAULT;
   Tcp4Option->MaxSynBackLog          = HTTP_MAX_SYN_BACK_LOG;
   Tcp4Option->ConnectionTimeout      = HTTP_CONNECTION_TIMEOUT;
@@ -1108,6 +1108,9 @@ HttpConfigureTcp4 (
   Tcp4Option->KeepAliveTime          = HTTP_KEEP_ALIVE_TIME;
   Tcp4Option->KeepAliveInterval      = HTTP_KEEP_ALIVE_INTERVAL;
   Tcp4Option->EnableNagle            = TRUE;
+  Tcp4Option->EnableWindowScaling    = TRUE;
+  Tcp4Option->EnableTimeStamp        = TRUE;
+  Tcp4Option->EnableSelectiveAck     = TRUE;
   Tcp4CfgData->ControlOption         = Tcp4Option;
 
   Status = HttpInstance->Tcp4->Configure (HttpInstance->Tcp4, Tcp4CfgData);
@@ -1169,7 +1172,7 @@ HttpConfigureTcp6 (
   IP6_COPY_ADDRESS (&Tcp6Ap->RemoteAddress , &HttpInstance->RemoteIpv6Addr);
 
   Tcp6Option = Tcp6CfgData->ControlOption;
-  Tcp6Option->ReceiveBufferSize  = HTTP_BUFFER_SIZE_DEAULT;
+  Tcp6Option->ReceiveBufferSize  = PcdGet32 (PcdHttpReceiveBufferSize);
   Tcp6Option->SendBufferSize     = HTTP_BUFFER_SIZE_DEAULT;
   Tcp6Option->MaxSynBackLog      = HTTP_MAX_SYN_BACK_LOG;
   Tcp6Option->ConnectionTimeout  = HTTP_CONNECTION_TIMEOUT;
@@ -1179,6 +1182,9 @@ HttpConfigureTcp6 (
   Tcp6Option->KeepAliveTime      = HTTP_KEEP_ALIVE_TIME;
   Tcp6Option->KeepAliveInterval  = HTTP_KEEP_ALIVE_INTERVAL;
   Tcp6Option->EnableNagle        = TRUE;
+  Tcp6Option->EnableWindowScaling = TRUE;
+  Tcp6Option->EnableTimeStamp    = TRUE;
+  Tcp6Option->EnableSelectiveAck = TRUE;
 
   Status = HttpInstance->Tcp6->Configure (HttpInstance->Tcp6, Tcp6CfgData);
   if (EFI_ERROR (Status)) {
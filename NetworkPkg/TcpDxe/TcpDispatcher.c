@@ -126,7 +126,7 @@ Tcp4GetMode (
       Option->EnableTimeStamp        = (BOOLEAN) (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_TS));
       Option->EnableWindowScaling    = (BOOLEAN) (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_WS));
 
-      Option->EnableSelectiveAck     = FALSE;
+      Option->EnableSelectiveAck     = (BOOLEAN) (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK));
       Option->EnablePathMtuDiscovery = FALSE;
     }
   }
@@ -204,7 +204,7 @@ Tcp6GetMode (
       Option->EnableTimeStamp        = (BOOLEAN) (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_TS));
       Option->EnableWindowScaling    = (BOOLEAN) (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_WS));
 
-      Option->EnableSelectiveAck     = FALSE;
+      Option->EnableSelectiveAck     = (BOOLEAN) (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK));
       Option->EnablePathMtuDiscovery = FALSE;
     }
   }
@@ -462,6 +462,7 @@ TcpConfigurePcb (
   TCP_PROTO_DATA       *TcpProto;
   TCP_CB               *Tcb;
   TCP_ACCESS_POINT     *TcpAp;
+  UINT32               RcvBufferSizeMax;
 
   ASSERT ((CfgData != NULL) && (Sk != NULL) && (Sk->SockHandle != NULL));
 
@@ -616,12 +617,17 @@ TcpConfigurePcb (
   }
 
   if (Option != NULL) {
+    //
+    // The receive buffer size is limited by the platform, and the window scale
+    // option lets the whole buffer be advertised to the peer.
+    //
+    RcvBufferSizeMax = MAX (PcdGet32 (PcdTcpMaxReceiveBufferSize), TCP_RCV_BUF_SIZE_MIN);
     SET_RCV_BUFFSIZE (
       Sk,
       (UINT32) (TCP_COMP_VAL (
                   TCP_RCV_BUF_SIZE_MIN,
-                  TCP_RCV_BUF_SIZE,
-                  TCP_RCV_BUF_SIZE,
+                  RcvBufferSizeMax,
+                  MIN (TCP_RCV_BUF_SIZE, RcvBufferSizeMax),
                   Option->ReceiveBufferSize
                   )
                )
@@ -713,6 +719,10 @@ TcpConfigurePcb (
     if (!Option->EnableWindowScaling) {
       TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_NO_WS);
     }
+
+    if (!Option->EnableSelectiveAck) {
+      TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_NO_SACK);
+    }
   }
 
   //
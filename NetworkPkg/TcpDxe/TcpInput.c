@@ -1555,6 +1555,14 @@ StepSix:
       goto RESET_THEN_DROP;
     }
 
+    //
+    // Remember the latest out-of-order segment, it goes to
+    // the first block of the SACK option.
+    //
+    if (TCP_SEQ_GT (Seg->Seq, Tcb->RcvNxt)) {
+      Tcb->SackSeq = Seg->Seq;
+    }
+
     if (TcpQueueData (Tcb, Nbuf) == 0) {
       DEBUG (
         (EFI_D_ERROR,
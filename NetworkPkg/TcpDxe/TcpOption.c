@@ -165,6 +165,28 @@ TcpSynBuildOption (
     TcpPutUint32 (Data, TCP_OPTION_WS_FAST | TcpComputeScale (Tcb));
   }
 
+  //
+  // Build SACK permitted option, only when configured
+  // to send SACK option, and either we are doing active
+  // open or we have received SACK permitted option from peer.
+  //
+  if (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK) &&
+      (!TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_ACK) ||
+        TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_SACK))
+      ) {
+
+    Data = NetbufAllocSpace (
+             Nbuf,
+             TCP_OPTION_SACK_PERM_ALIGNED_LEN,
+             NET_BUF_HEAD
+             );
+
+    ASSERT (Data != NULL);
+
+    Len += TCP_OPTION_SACK_PERM_ALIGNED_LEN;
+    TcpPutUint32 (Data, TCP_OPTION_SACK_PERM_FAST);
+  }
+
   //
   // Build the MSS option.
   //
@@ -177,6 +199,46 @@ TcpSynBuildOption (
   return Len;
 }
 
+/**
+  Get the next block of contiguous data in the reassemble queue.
+
+  @param[in]       Tcb     Pointer to the TCP_CB of this TCP instance.
+  @param[in, out]  Entry   On input, the entry the block starts with. On output,
+                           the entry following the block.
+  @param[out]      Left    The first sequence number of the block.
+  @param[out]      Right   The sequence number following the block.
+
+**/
+VOID
+TcpGetSackBlock (
+  IN     TCP_CB     *Tcb,
+  IN OUT LIST_ENTRY **Entry,
+     OUT TCP_SEQNO  *Left,
+     OUT TCP_SEQNO  *Right
+  )
+{
+  TCP_SEG *Seg;
+
+  Seg     = TCPSEG_NETBUF (NET_LIST_USER_STRUCT (*Entry, NET_BUF, List));
+  *Left   = Seg->Seq;
+  *Right  = Seg->End;
+  *Entry  = (*Entry)->ForwardLink;
+
+  while (*Entry != &Tcb->RcvQue) {
+    Seg = TCPSEG_NETBUF (NET_LIST_USER_STRUCT (*Entry, NET_BUF, List));
+
+    if (TCP_SEQ_GT (Seg->Seq, *Right)) {
+      break;
+    }
+
+    if (TCP_SEQ_GT (Seg->End, *Right)) {
+      *Right = Seg->End;
+    }
+
+    *Entry = (*Entry)->ForwardLink;
+  }
+}
+
 /**
   Build the TCP option in synchronized states.
 
@@ -192,11 +254,21 @@ TcpBuildOption (
   IN NET_BUF *Nbuf
   )
 {
-  UINT8   *Data;
-  UINT16  Len;
+  UINT8       *Data;
+  UINT16      Len;
+  UINT32      DataLen;
+  LIST_ENTRY  *Entry;
+  TCP_SEQNO   Left;
+  TCP_SEQNO   Right;
+  TCP_SEQNO   SackLeft[(TCP_OPTION_MAX_LEN - TCP_OPTION_SACK_HEAD_ALIGNED_LEN) / TCP_OPTION_SACK_BLOCK_LEN];
+  TCP_SEQNO   SackRight[(TCP_OPTION_MAX_LEN - TCP_OPTION_SACK_HEAD_ALIGNED_LEN) / TCP_OPTION_SACK_BLOCK_LEN];
+  UINTN       MaxBlocks;
+  UINTN       Blocks;
+  UINTN       Index;
 
   ASSERT ((Tcb != NULL) && (Nbuf != NULL) && (Nbuf->Tcp == NULL));
-  Len = 0;
+  Len     = 0;
+  DataLen = Nbuf->TotalSize;
 
   //
   // Build the Timestamp option.
@@ -219,6 +291,66 @@ TcpBuildOption (
     TcpPutUint32 (Data + 8, Tcb->TsRecent);
   }
 
+  //
+  // Build the SACK option to report the out-of-order data in the reassemble
+  // queue, the block with the latest received segment first (RFC2018). It is
+  // only added to the segments without data, whose size is not limited by
+  // the MSS.
+  //
+  if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_SACK) &&
+      !TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_RST) &&
+      (DataLen == 0) &&
+      !IsListEmpty (&Tcb->RcvQue)
+      ) {
+
+    MaxBlocks = (TCP_OPTION_MAX_LEN - Len - TCP_OPTION_SACK_HEAD_ALIGNED_LEN) / TCP_OPTION_SACK_BLOCK_LEN;
+    Blocks    = 0;
+
+    Entry     = Tcb->RcvQue.ForwardLink;
+    while (Entry != &Tcb->RcvQue) {
+      TcpGetSackBlock (Tcb, &Entry, &Left, &Right);
+
+      if (TCP_SEQ_LEQ (Left, Tcb->SackSeq) && TCP_SEQ_LT (Tcb->SackSeq, Right)) {
+        SackLeft[0]  = Left;
+        SackRight[0] = Right;
+        Blocks       = 1;
+        break;
+      }
+    }
+
+    Entry = Tcb->RcvQue.ForwardLink;
+    while ((Entry != &Tcb->RcvQue) && (Blocks < MaxBlocks)) {
+      TcpGetSackBlock (Tcb, &Entry, &Left, &Right);
+
+      if (TCP_SEQ_LEQ (Right, Tcb->RcvNxt) ||
+          ((Blocks > 0) && (Left == SackLeft[0]))
+          ) {
+        continue;
+      }
+
+      SackLeft[Blocks]  = Left;
+      SackRight[Blocks] = Right;
+      Blocks++;
+    }
+
+    if (Blocks != 0) {
+      Data = NetbufAllocSpace (
+               Nbuf,
+               (UINT32) (TCP_OPTION_SACK_HEAD_ALIGNED_LEN + Blocks * TCP_OPTION_SACK_BLOCK_LEN),
+               NET_BUF_HEAD
+               );
+
+      ASSERT (Data != NULL);
+      Len = (UINT16) (Len + TCP_OPTION_SACK_HEAD_ALIGNED_LEN + Blocks * TCP_OPTION_SACK_BLOCK_LEN);
+
+      TcpPutUint32 (Data, TCP_OPTION_SACK_FAST | (UINT32) (2 + Blocks * TCP_OPTION_SACK_BLOCK_LEN));
+      for (Index = 0; Index < Blocks; Index++) {
+        TcpPutUint32 (Data + TCP_OPTION_SACK_HEAD_ALIGNED_LEN + Index * TCP_OPTION_SACK_BLOCK_LEN, SackLeft[Index]);
+        TcpPutUint32 (Data + TCP_OPTION_SACK_HEAD_ALIGNED_LEN + Index * TCP_OPTION_SACK_BLOCK_LEN + 4, SackRight[Index]);
+      }
+    }
+  }
+
   return Len;
 }
 
@@ -304,6 +436,19 @@ TcpParseOption (
       Cur += TCP_OPTION_WS_LEN;
       break;
 
+    case TCP_OPTION_SACK_PERM:
+      Len = Head[Cur + 1];
+
+      if ((Len != TCP_OPTION_SACK_PERM_LEN) || (TotalLen - Cur < TCP_OPTION_SACK_PERM_LEN)) {
+
+        return -1;
+      }
+
+      TCP_SET_FLG (Option->Flag, TCP_OPTION_RCVD_SACK_PERM);
+
+      Cur += TCP_OPTION_SACK_PERM_LEN;
+      break;
+
     case TCP_OPTION_TS:
       Len = Head[Cur + 1];
 
@@ -78,6 +78,8 @@
 #define TCP_CTRL_TIMER_ON        0x1000 ///< At least one of the timer is on.
 #define TCP_CTRL_RTT_ON          0x2000 ///< The RTT measurement is on.
 #define TCP_CTRL_ACK_NOW         0x4000 ///< Send the ACK now, don't delay.
+#define TCP_CTRL_NO_SACK         0x8000 ///< Disable SACK option.
+#define TCP_CTRL_SND_SACK        0x10000 ///< Received SACK permitted in syn, send SACK option.
 
 //
 // Timer related values
@@ -294,6 +296,11 @@ struct _TCP_CONTROL_BLOCK {
   UINT32            TsRecent;     ///< TsRecent to echo to the remote peer.
   UINT32            TsRecentAge;  ///< When this TsRecent is updated.
 
+  //
+  // RFC2018 defined variables, about selective acknowledgment
+  //
+  TCP_SEQNO         SackSeq;      ///< Seq of the latest out-of-order segment received.
+
   //
   // RFC2988 defined variables. about RTT measurement
   //
@@ -102,6 +102,10 @@ EFI_CPU_ARCH_PROTOCOL  gCpu = {
   4                           // DmaBufferAlignment
 };
 
+EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL  mMemoryAttributeBatch = {
+  CpuSetMemoryAttributesBatch
+};
+
 //
 // CPU Arch Protocol Functions
 //
@@ -354,6 +358,105 @@ SetMtrrsFromBuffer (
   MtrrSetAllMtrrs (Buffer);
 }
 
+/**
+  Update the MTRR cache type of the memory region specified by BaseAddress and
+  Length, and synchronize the new MTRR settings with all APs.
+
+  @param  BaseAddress      The physical address that is the start address of a memory region.
+  @param  Length           The size in bytes of the memory region.
+  @param  CacheAttributes  The cache attribute to set for the memory region.
+
+  @retval EFI_SUCCESS           The cache type was set for the memory region.
+  @retval EFI_INVALID_PARAMETER CacheAttributes is not a single cache attribute.
+  @retval EFI_UNSUPPORTED       MTRRs are not supported.
+  @return others                The return value of MtrrSetMemoryAttribute().
+
+**/
+STATIC
+EFI_STATUS
+SetMemoryCacheAttributes (
+  IN EFI_PHYSICAL_ADDRESS      BaseAddress,
+  IN UINT64                    Length,
+  IN UINT64                    CacheAttributes
+  )
+{
+  RETURN_STATUS             Status;
+  MTRR_MEMORY_CACHE_TYPE    CacheType;
+  EFI_STATUS                MpStatus;
+  EFI_MP_SERVICES_PROTOCOL  *MpService;
+  MTRR_SETTINGS             MtrrSettings;
+  MTRR_MEMORY_CACHE_TYPE    CurrentCacheType;
+
+  if (!IsMtrrSupported ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  switch (CacheAttributes) {
+  case EFI_MEMORY_UC:
+    CacheType = CacheUncacheable;
+    break;
+
+  case EFI_MEMORY_WC:
+    CacheType = CacheWriteCombining;
+    break;
+
+  case EFI_MEMORY_WT:
+    CacheType = CacheWriteThrough;
+    break;
+
+  case EFI_MEMORY_WP:
+    CacheType = CacheWriteProtected;
+    break;
+
+  case EFI_MEMORY_WB:
+    CacheType = CacheWriteBack;
+    break;
+
+  default:
+    return EFI_INVALID_PARAMETER;
+  }
+  CurrentCacheType = MtrrGetMemoryAttribute(BaseAddress);
+  if (CurrentCacheType != CacheType) {
+    //
+    // call MTRR libary function
+    //
+    Status = MtrrSetMemoryAttribute (
+               BaseAddress,
+               Length,
+               CacheType
+               );
+
+    if (!RETURN_ERROR (Status)) {
+      MpStatus = gBS->LocateProtocol (
+                        &gEfiMpServiceProtocolGuid,
+                        NULL,
+                        (VOID **)&MpService
+                        );
+      //
+      // Synchronize the update with all APs
+      //
+      if (!EFI_ERROR (MpStatus)) {
+        MtrrGetAllMtrrs (&MtrrSettings);
+        MpStatus = MpService->StartupAllAPs (
+                                MpService,          // This
+                                SetMtrrsFromBuffer, // Procedure
+                                FALSE,              // SingleThread
+                                NULL,               // WaitEvent
+                                0,                  // TimeoutInMicrosecsond
+                                &MtrrSettings,      // ProcedureArgument
+                                NULL                // FailedCpuList
+                                );
+        ASSERT (MpStatus == EFI_SUCCESS || MpStatus == EFI_NOT_STARTED);
+      }
+    }
+    if (EFI_ERROR(Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Implementation of SetMemoryAttributes() service of CPU Architecture Protocol.
 
@@ -388,14 +491,9 @@ CpuSetMemoryAttributes (
   IN UINT64                    Attributes
   )
 {
-  RETURN_STATUS             Status;
-  MTRR_MEMORY_CACHE_TYPE    CacheType;
-  EFI_STATUS                MpStatus;
-  EFI_MP_SERVICES_PROTOCOL  *MpService;
-  MTRR_SETTINGS             MtrrSettings;
+  EFI_STATUS                Status;
   UINT64                    CacheAttributes;
   UINT64                    MemoryAttributes;
-  MTRR_MEMORY_CACHE_TYPE    CurrentCacheType;
 
   //
   // If this function is called because GCD SetMemorySpaceAttributes () is called
@@ -431,78 +529,111 @@ CpuSetMemoryAttributes (
   }
 
   if (CacheAttributes != 0) {
-    if (!IsMtrrSupported ()) {
-      return EFI_UNSUPPORTED;
+    Status = SetMemoryCacheAttributes (BaseAddress, Length, CacheAttributes);
+    if (EFI_ERROR (Status)) {
+      return Status;
     }
+  }
 
-    switch (CacheAttributes) {
-    case EFI_MEMORY_UC:
-      CacheType = CacheUncacheable;
-      break;
+  //
+  // Set memory attribute by page table
+  //
+  return AssignMemoryPageAttributes (NULL, BaseAddress, Length, MemoryAttributes, NULL);
+}
+
+/**
+  Set the cache type of one range of a batch, before its page attributes are
+  assigned.
+
+  @param  Range            The memory range and attributes.
+
+  @retval EFI_SUCCESS      The cache type was set, or the range has none.
+  @return others           The return value of SetMemoryCacheAttributes().
+
+**/
+STATIC
+RETURN_STATUS
+EFIAPI
+SetRangeCacheAttributes (
+  IN CONST EDKII_MEMORY_ATTRIBUTE_RANGE  *Range
+  )
+{
+  UINT64                    CacheAttributes;
 
-    case EFI_MEMORY_WC:
-      CacheType = CacheWriteCombining;
-      break;
+  CacheAttributes = Range->Attributes & CACHE_ATTRIBUTE_MASK;
+  if (CacheAttributes == 0) {
+    return EFI_SUCCESS;
+  }
 
-    case EFI_MEMORY_WT:
-      CacheType = CacheWriteThrough;
-      break;
+  return SetMemoryCacheAttributes (Range->BaseAddress, Range->Length, CacheAttributes);
+}
+
+/**
+  Implementation of SetMemoryAttributesBatch() service of Memory Attribute
+  Batch Protocol.
 
-    case EFI_MEMORY_WP:
-      CacheType = CacheWriteProtected;
-      break;
+  Each range is handled as by CpuSetMemoryAttributes(), but the page table is
+  updated in one pass and the TLB is flushed only once for the whole list. A
+  range whose cache type can't be set keeps its page attributes.
 
-    case EFI_MEMORY_WB:
-      CacheType = CacheWriteBack;
-      break;
+  @param  This             The EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL instance.
+  @param  Ranges           Pointer to the list of memory attribute updates.
+  @param  RangeCount       Number of entries in Ranges.
 
-    default:
+  @retval EFI_SUCCESS           The attributes were set for all memory regions.
+  @retval EFI_INVALID_PARAMETER Ranges is NULL and RangeCount is not zero.
+                                Length of one range is zero.
+                                Attributes of one range specified an illegal
+                                combination of attributes. No range was updated.
+  @return others                The status of the first memory region that failed.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuSetMemoryAttributesBatch (
+  IN EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL  *This,
+  IN CONST EDKII_MEMORY_ATTRIBUTE_RANGE     *Ranges,
+  IN UINTN                                  RangeCount
+  )
+{
+  UINT64                    CacheAttributes;
+  UINTN                     Index;
+
+  //
+  // See CpuSetMemoryAttributes() for why these two cases are ignored.
+  //
+  if (mIsFlushingGCD || mIsAllocatingPageTable) {
+    return EFI_SUCCESS;
+  }
+
+  if ((Ranges == NULL) && (RangeCount != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Validate the whole list up front so that a bad entry does not leave the
+  // page table half updated.
+  //
+  for (Index = 0; Index < RangeCount; Index++) {
+    if ((Ranges[Index].Length == 0) ||
+        ((Ranges[Index].Attributes & ~(CACHE_ATTRIBUTE_MASK | MEMORY_ATTRIBUTE_MASK)) != 0)) {
       return EFI_INVALID_PARAMETER;
     }
-    CurrentCacheType = MtrrGetMemoryAttribute(BaseAddress);
-    if (CurrentCacheType != CacheType) {
-      //
-      // call MTRR libary function
-      //
-      Status = MtrrSetMemoryAttribute (
-                 BaseAddress,
-                 Length,
-                 CacheType
-                 );
-
-      if (!RETURN_ERROR (Status)) {
-        MpStatus = gBS->LocateProtocol (
-                          &gEfiMpServiceProtocolGuid,
-                          NULL,
-                          (VOID **)&MpService
-                          );
-        //
-        // Synchronize the update with all APs
-        //
-        if (!EFI_ERROR (MpStatus)) {
-          MtrrGetAllMtrrs (&MtrrSettings);
-          MpStatus = MpService->StartupAllAPs (
-                                  MpService,          // This
-                                  SetMtrrsFromBuffer, // Procedure
-                                  FALSE,              // SingleThread
-                                  NULL,               // WaitEvent
-                                  0,                  // TimeoutInMicrosecsond
-                                  &MtrrSettings,      // ProcedureArgument
-                                  NULL                // FailedCpuList
-                                  );
-          ASSERT (MpStatus == EFI_SUCCESS || MpStatus == EFI_NOT_STARTED);
-        }
-      }
-      if (EFI_ERROR(Status)) {
-        return Status;
-      }
+
+    //
+    // At most one cache type, among those SetMemoryCacheAttributes() takes.
+    //
+    CacheAttributes = Ranges[Index].Attributes & CACHE_ATTRIBUTE_MASK;
+    if (((CacheAttributes & (CacheAttributes - 1)) != 0) ||
+        (CacheAttributes == EFI_MEMORY_UCE)) {
+      return EFI_INVALID_PARAMETER;
     }
   }
 
   //
-  // Set memory attribute by page table
+  // Set the cache type of each range, then its memory attribute by page table
   //
-  return AssignMemoryPageAttributes (NULL, BaseAddress, Length, MemoryAttributes, NULL);
+  return AssignMemoryPageAttributesBatch (Ranges, RangeCount, SetRangeCacheAttributes, NULL);
 }
 
 /**
@@ -1185,11 +1316,12 @@ InitializeCpu (
   InitInterruptDescriptorTable ();
 
   //
-  // Install CPU Architectural Protocol
+  // Install CPU Architectural Protocol and Memory Attribute Batch Protocol
   //
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &mCpuHandle,
                   &gEfiCpuArchProtocolGuid, &gCpu,
+                  &gEdkiiMemoryAttributeBatchProtocolGuid, &mMemoryAttributeBatch,
                   NULL
                   );
   ASSERT_EFI_ERROR (Status);
@@ -19,6 +19,7 @@
 
 #include <Protocol/Cpu.h>
 #include <Protocol/MpService.h>
+#include <Protocol/MemoryAttributeBatch.h>
 #include <Register/Msr.h>
 
 #include <Ppi/SecPlatformInformation.h>
@@ -238,6 +239,30 @@ CpuSetMemoryAttributes (
   IN UINT64                     Attributes
   );
 
+/**
+  Implementation of SetMemoryAttributesBatch() service of Memory Attribute
+  Batch Protocol.
+
+  @param  This             The EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL instance.
+  @param  Ranges           Pointer to the list of memory attribute updates.
+  @param  RangeCount       Number of entries in Ranges.
+
+  @retval EFI_SUCCESS           The attributes were set for all memory regions.
+  @retval EFI_INVALID_PARAMETER Ranges is NULL and RangeCount is not zero.
+                                Length of one range is zero.
+                                Attributes of one range specified an illegal
+                                combination of attributes. No range was updated.
+  @return others                The status of the first memory region that failed.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuSetMemoryAttributesBatch (
+  IN EDKII_MEMORY_ATTRIBUTE_BATCH_PROTOCOL  *This,
+  IN CONST EDKII_MEMORY_ATTRIBUTE_RANGE     *Ranges,
+  IN UINTN                                  RangeCount
+  );
+
 /**
   Initialize Global Descriptor Table.
 
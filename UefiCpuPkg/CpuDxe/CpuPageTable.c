@@ -869,6 +869,89 @@ AssignMemoryPageAttributes (
   return Status;
 }
 
+/**
+  This function assigns the page attributes for a list of memory regions, in
+  list order, using the page table of the current CPU context.
+
+  The TLB is flushed once after all regions have been converted, instead of
+  once per region. A failure on one region does not stop the conversion of
+  the following regions.
+
+  @param[in]  Ranges            The list of memory regions and attributes. Only the
+                                EFI_MEMORY_RP, EFI_MEMORY_RO and EFI_MEMORY_XP bits
+                                of each Attributes field are used.
+  @param[in]  RangeCount        The number of entries in Ranges.
+  @param[in]  PrepareRangeFunc  If not NULL, this function is called for each region
+                                before its page attributes are assigned. The regions
+                                it fails are skipped.
+  @param[in]  AllocatePagesFunc If page split is needed, this function is used to allocate more pages.
+                                NULL mean page split is unsupported.
+
+  @retval RETURN_SUCCESS           The attributes were assigned for all memory regions.
+  @return others                   The status of the first memory region that failed,
+                                   see AssignMemoryPageAttributes().
+**/
+RETURN_STATUS
+EFIAPI
+AssignMemoryPageAttributesBatch (
+  IN  CONST EDKII_MEMORY_ATTRIBUTE_RANGE  *Ranges,
+  IN  UINTN                               RangeCount,
+  IN  PAGE_TABLE_LIB_PREPARE_RANGE        PrepareRangeFunc OPTIONAL,
+  IN  PAGE_TABLE_LIB_ALLOCATE_PAGES       AllocatePagesFunc OPTIONAL
+  )
+{
+  PAGE_TABLE_LIB_PAGING_CONTEXT     PagingContext;
+  RETURN_STATUS                     Status;
+  RETURN_STATUS                     RangeStatus;
+  BOOLEAN                           IsModified;
+  BOOLEAN                           IsSplitted;
+  BOOLEAN                           NeedFlush;
+  UINTN                             Index;
+
+  //
+  // The paging context is looked up once for the whole list.
+  //
+  GetCurrentPagingContext (&PagingContext);
+
+  Status    = RETURN_SUCCESS;
+  NeedFlush = FALSE;
+  for (Index = 0; Index < RangeCount; Index++) {
+    IsModified  = FALSE;
+    RangeStatus = RETURN_SUCCESS;
+    if (PrepareRangeFunc != NULL) {
+      RangeStatus = PrepareRangeFunc (&Ranges[Index]);
+    }
+    if (!RETURN_ERROR (RangeStatus)) {
+      RangeStatus = ConvertMemoryPageAttributes (
+                      &PagingContext,
+                      Ranges[Index].BaseAddress,
+                      Ranges[Index].Length,
+                      Ranges[Index].Attributes & (EFI_MEMORY_RP | EFI_MEMORY_RO | EFI_MEMORY_XP),
+                      PageActionAssign,
+                      AllocatePagesFunc,
+                      &IsSplitted,
+                      &IsModified
+                      );
+    }
+    if (IsModified) {
+      NeedFlush = TRUE;
+    }
+    if (RETURN_ERROR (RangeStatus) && !RETURN_ERROR (Status)) {
+      Status = RangeStatus;
+    }
+  }
+
+  if (NeedFlush) {
+    //
+    // Flush TLB once for all regions. The same note as in
+    // AssignMemoryPageAttributes() applies to APs.
+    //
+    CpuFlushTlb();
+  }
+
+  return Status;
+}
+
 /**
  Check if Execute Disable feature is enabled or not.
 **/
@@ -77,6 +77,22 @@ VOID *
   IN UINTN  Pages
   );
 
+/**
+  Prepares one memory region of a batch before its page attributes are
+  assigned.
+
+  @param  Range                 The memory region and attributes.
+
+  @retval RETURN_SUCCESS        The page attributes of the region can be assigned.
+  @return others                The region failed, its page attributes are left unchanged.
+
+**/
+typedef
+RETURN_STATUS
+(EFIAPI *PAGE_TABLE_LIB_PREPARE_RANGE) (
+  IN CONST EDKII_MEMORY_ATTRIBUTE_RANGE  *Range
+  );
+
 /**
   This function assigns the page attributes for the memory region specified by BaseAddress and
   Length from their current attributes to the attributes specified by Attributes.
@@ -115,6 +131,37 @@ AssignMemoryPageAttributes (
   IN  PAGE_TABLE_LIB_ALLOCATE_PAGES     AllocatePagesFunc OPTIONAL
   );
 
+/**
+  This function assigns the page attributes for a list of memory regions, in
+  list order, using the page table of the current CPU context.
+
+  The TLB is flushed once after all regions have been converted, instead of
+  once per region. A failure on one region does not stop the conversion of
+  the following regions.
+
+  @param  Ranges            The list of memory regions and attributes. Only the
+                            EFI_MEMORY_RP, EFI_MEMORY_RO and EFI_MEMORY_XP bits
+                            of each Attributes field are used.
+  @param  RangeCount        The number of entries in Ranges.
+  @param  PrepareRangeFunc  If not NULL, this function is called for each region
+                            before its page attributes are assigned. The regions
+                            it fails are skipped.
+  @param  AllocatePagesFunc If page split is needed, this function is used to allocate more pages.
+                            NULL mean page split is unsupported.
+
+  @retval RETURN_SUCCESS           The attributes were assigned for all memory regions.
+  @return others                   The status of the first memory region that failed,
+                                   see AssignMemoryPageAttributes().
+**/
+RETURN_STATUS
+EFIAPI
+AssignMemoryPageAttributesBatch (
+  IN  CONST EDKII_MEMORY_ATTRIBUTE_RANGE  *Ranges,
+  IN  UINTN                               RangeCount,
+  IN  PAGE_TABLE_LIB_PREPARE_RANGE        PrepareRangeFunc OPTIONAL,
+  IN  PAGE_TABLE_LIB_ALLOCATE_PAGES       AllocatePagesFunc OPTIONAL
+  );
+
 /**
   Initialize the Page Table lib.
 **/